@@ -0,0 +1,64 @@
+#ifndef _ROS_lexxauto_msgs_ImuBatch_h
+#define _ROS_lexxauto_msgs_ImuBatch_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+#include "lexxauto_msgs/ImuSample.h"
+
+namespace lexxauto_msgs
+{
+
+  class ImuBatch : public ros::Msg
+  {
+    public:
+      uint32_t samples_length;
+      typedef lexxauto_msgs::ImuSample _samples_type;
+      _samples_type st_samples;
+      _samples_type * samples;
+
+    ImuBatch():
+      samples_length(0), st_samples(), samples(nullptr)
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      *(outbuffer + offset + 0) = (this->samples_length >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->samples_length >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (this->samples_length >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (this->samples_length >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->samples_length);
+      for( uint32_t i = 0; i < samples_length; i++){
+      offset += this->samples[i].serialize(outbuffer + offset);
+      }
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      uint32_t samples_lengthT = ((uint32_t) (*(inbuffer + offset)));
+      samples_lengthT |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      samples_lengthT |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      samples_lengthT |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      offset += sizeof(this->samples_length);
+      if(samples_lengthT > samples_length)
+        this->samples = (lexxauto_msgs::ImuSample*)realloc(this->samples, samples_lengthT * sizeof(lexxauto_msgs::ImuSample));
+      samples_length = samples_lengthT;
+      for( uint32_t i = 0; i < samples_length; i++){
+      offset += this->st_samples.deserialize(inbuffer + offset);
+        memcpy( &(this->samples[i]), &(this->st_samples), sizeof(lexxauto_msgs::ImuSample));
+      }
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/ImuBatch"; };
+    virtual const char * getMD5() override { return "3d8ab5caab718bb113c88118e3941b48"; };
+
+  };
+
+}
+#endif
@@ -0,0 +1,170 @@
+#ifndef _ROS_lexxauto_msgs_ImuSample_h
+#define _ROS_lexxauto_msgs_ImuSample_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+#include "ros/time.h"
+
+namespace lexxauto_msgs
+{
+
+  class ImuSample : public ros::Msg
+  {
+    public:
+      typedef ros::Time _stamp_type;
+      _stamp_type stamp;
+      float accel[3];
+      float gyro[3];
+      float ang[3];
+      float vel[3];
+
+    ImuSample():
+      stamp(),
+      accel(),
+      gyro(),
+      ang(),
+      vel()
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      *(outbuffer + offset + 0) = (this->stamp.sec >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->stamp.sec >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (this->stamp.sec >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (this->stamp.sec >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->stamp.sec);
+      *(outbuffer + offset + 0) = (this->stamp.nsec >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->stamp.nsec >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (this->stamp.nsec >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (this->stamp.nsec >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->stamp.nsec);
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_acceli;
+      u_acceli.real = this->accel[i];
+      *(outbuffer + offset + 0) = (u_acceli.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_acceli.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_acceli.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_acceli.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->accel[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_gyroi;
+      u_gyroi.real = this->gyro[i];
+      *(outbuffer + offset + 0) = (u_gyroi.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_gyroi.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_gyroi.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_gyroi.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->gyro[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_angi;
+      u_angi.real = this->ang[i];
+      *(outbuffer + offset + 0) = (u_angi.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_angi.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_angi.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_angi.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->ang[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_veli;
+      u_veli.real = this->vel[i];
+      *(outbuffer + offset + 0) = (u_veli.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_veli.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_veli.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_veli.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->vel[i]);
+      }
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      this->stamp.sec =  ((uint32_t) (*(inbuffer + offset)));
+      this->stamp.sec |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      this->stamp.sec |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      this->stamp.sec |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      offset += sizeof(this->stamp.sec);
+      this->stamp.nsec =  ((uint32_t) (*(inbuffer + offset)));
+      this->stamp.nsec |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      this->stamp.nsec |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      this->stamp.nsec |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      offset += sizeof(this->stamp.nsec);
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_acceli;
+      u_acceli.base = 0;
+      u_acceli.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_acceli.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_acceli.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_acceli.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->accel[i] = u_acceli.real;
+      offset += sizeof(this->accel[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_gyroi;
+      u_gyroi.base = 0;
+      u_gyroi.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_gyroi.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_gyroi.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_gyroi.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->gyro[i] = u_gyroi.real;
+      offset += sizeof(this->gyro[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_angi;
+      u_angi.base = 0;
+      u_angi.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_angi.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_angi.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_angi.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->ang[i] = u_angi.real;
+      offset += sizeof(this->ang[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_veli;
+      u_veli.base = 0;
+      u_veli.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_veli.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_veli.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_veli.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->vel[i] = u_veli.real;
+      offset += sizeof(this->vel[i]);
+      }
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/ImuSample"; };
+    virtual const char * getMD5() override { return "de434673766054bd233db2378b1c04b2"; };
+
+  };
+
+}
+#endif
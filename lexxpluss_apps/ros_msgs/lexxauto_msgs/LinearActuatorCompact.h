@@ -0,0 +1,70 @@
+#ifndef _ROS_lexxauto_msgs_LinearActuatorCompact_h
+#define _ROS_lexxauto_msgs_LinearActuatorCompact_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+
+namespace lexxauto_msgs
+{
+
+  class LinearActuatorCompact : public ros::Msg
+  {
+    public:
+      int16_t current_ma[3];
+      typedef uint16_t _shelf_connection_mv_type;
+      _shelf_connection_mv_type shelf_connection_mv;
+
+    LinearActuatorCompact():
+      current_ma(),
+      shelf_connection_mv()
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        int16_t real;
+        uint16_t base;
+      } u_current_mai;
+      u_current_mai.real = this->current_ma[i];
+      *(outbuffer + offset + 0) = (u_current_mai.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_current_mai.base >> (8 * 1)) & 0xFF;
+      offset += sizeof(this->current_ma[i]);
+      }
+      *(outbuffer + offset + 0) = (this->shelf_connection_mv >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->shelf_connection_mv >> (8 * 1)) & 0xFF;
+      offset += sizeof(this->shelf_connection_mv);
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        int16_t real;
+        uint16_t base;
+      } u_current_mai;
+      u_current_mai.base = 0;
+      u_current_mai.base |= ((uint16_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_current_mai.base |= ((uint16_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      this->current_ma[i] = u_current_mai.real;
+      offset += sizeof(this->current_ma[i]);
+      }
+      this->shelf_connection_mv =  ((uint16_t) (*(inbuffer + offset)));
+      this->shelf_connection_mv |= ((uint16_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      offset += sizeof(this->shelf_connection_mv);
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/LinearActuatorCompact"; };
+    virtual const char * getMD5() override { return "b5f277bb37d72ec28e55f946b6057b57"; };
+
+  };
+
+}
+#endif
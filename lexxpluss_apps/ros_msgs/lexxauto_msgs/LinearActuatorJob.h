@@ -0,0 +1,121 @@
+#ifndef _ROS_lexxauto_msgs_LinearActuatorJob_h
+#define _ROS_lexxauto_msgs_LinearActuatorJob_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+
+namespace lexxauto_msgs
+{
+
+  class LinearActuatorJob : public ros::Msg
+  {
+    public:
+      typedef uint32_t _id_type;
+      _id_type id;
+      typedef uint8_t _type_type;
+      _type_type type;
+      typedef uint8_t _state_type;
+      _state_type state;
+      typedef uint32_t _elapsed_ms_type;
+      _elapsed_ms_type elapsed_ms;
+      typedef uint8_t _moving_type;
+      _moving_type moving;
+      uint8_t detail[3];
+      enum { INIT = 0 };
+      enum { LOCATION = 1 };
+      enum { ACCEPTED = 0 };
+      enum { RUNNING = 1 };
+      enum { SUCCEEDED = 2 };
+      enum { FAILED = 3 };
+
+    LinearActuatorJob():
+      id(),
+      type(),
+      state(),
+      elapsed_ms(),
+      moving(),
+      detail()
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      *(outbuffer + offset + 0) = (this->id >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->id >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (this->id >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (this->id >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->id);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_type;
+      u_type.real = this->type;
+      *(outbuffer + offset + 0) = (u_type.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->type);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_state;
+      u_state.real = this->state;
+      *(outbuffer + offset + 0) = (u_state.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->state);
+      *(outbuffer + offset + 0) = (this->elapsed_ms >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->elapsed_ms >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (this->elapsed_ms >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (this->elapsed_ms >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->elapsed_ms);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_moving;
+      u_moving.real = this->moving;
+      *(outbuffer + offset + 0) = (u_moving.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->moving);
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_detaili;
+      u_detaili.real = this->detail[i];
+      *(outbuffer + offset + 0) = (u_detaili.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->detail[i]);
+      }
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      this->id =  ((uint32_t) (*(inbuffer + offset)));
+      this->id |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      this->id |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      this->id |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      offset += sizeof(this->id);
+      this->type =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->type);
+      this->state =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->state);
+      this->elapsed_ms =  ((uint32_t) (*(inbuffer + offset)));
+      this->elapsed_ms |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      this->elapsed_ms |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      this->elapsed_ms |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      offset += sizeof(this->elapsed_ms);
+      this->moving =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->moving);
+      for( uint32_t i = 0; i < 3; i++){
+      this->detail[i] =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->detail[i]);
+      }
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/LinearActuatorJob"; };
+    virtual const char * getMD5() override { return "6d3ecacb794352b533661b4cce8f1629"; };
+
+  };
+
+}
+#endif
@@ -0,0 +1,218 @@
+#ifndef _ROS_lexxauto_msgs_PositionGuideVisionStamped_h
+#define _ROS_lexxauto_msgs_PositionGuideVisionStamped_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+#include "std_msgs/Header.h"
+
+namespace lexxauto_msgs
+{
+
+  class PositionGuideVisionStamped : public ros::Msg
+  {
+    public:
+      typedef std_msgs::Header _header_type;
+      _header_type header;
+      typedef float _angle_type;
+      _angle_type angle;
+      typedef float _x_pos_type;
+      _x_pos_type x_pos;
+      typedef float _y_pos_type;
+      _y_pos_type y_pos;
+      typedef uint8_t _color_lane_count_type;
+      _color_lane_count_type color_lane_count;
+      typedef bool _no_color_lane_type;
+      _no_color_lane_type no_color_lane;
+      typedef bool _no_pos_type;
+      _no_pos_type no_pos;
+      typedef bool _tag_detected_type;
+      _tag_detected_type tag_detected;
+      typedef bool _control_code1_detected_type;
+      _control_code1_detected_type control_code1_detected;
+      typedef bool _control_code2_detected_type;
+      _control_code2_detected_type control_code2_detected;
+
+    PositionGuideVisionStamped():
+      header(),
+      angle(),
+      x_pos(),
+      y_pos(),
+      color_lane_count(),
+      no_color_lane(),
+      no_pos(),
+      tag_detected(),
+      control_code1_detected(),
+      control_code2_detected()
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      offset += this->header.serialize(outbuffer + offset);
+      union {
+        float real;
+        uint32_t base;
+      } u_angle;
+      u_angle.real = this->angle;
+      *(outbuffer + offset + 0) = (u_angle.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_angle.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_angle.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_angle.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->angle);
+      union {
+        float real;
+        uint32_t base;
+      } u_x_pos;
+      u_x_pos.real = this->x_pos;
+      *(outbuffer + offset + 0) = (u_x_pos.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_x_pos.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_x_pos.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_x_pos.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->x_pos);
+      union {
+        float real;
+        uint32_t base;
+      } u_y_pos;
+      u_y_pos.real = this->y_pos;
+      *(outbuffer + offset + 0) = (u_y_pos.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_y_pos.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_y_pos.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_y_pos.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->y_pos);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_color_lane_count;
+      u_color_lane_count.real = this->color_lane_count;
+      *(outbuffer + offset + 0) = (u_color_lane_count.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->color_lane_count);
+      union {
+        bool real;
+        uint8_t base;
+      } u_no_color_lane;
+      u_no_color_lane.real = this->no_color_lane;
+      *(outbuffer + offset + 0) = (u_no_color_lane.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->no_color_lane);
+      union {
+        bool real;
+        uint8_t base;
+      } u_no_pos;
+      u_no_pos.real = this->no_pos;
+      *(outbuffer + offset + 0) = (u_no_pos.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->no_pos);
+      union {
+        bool real;
+        uint8_t base;
+      } u_tag_detected;
+      u_tag_detected.real = this->tag_detected;
+      *(outbuffer + offset + 0) = (u_tag_detected.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->tag_detected);
+      union {
+        bool real;
+        uint8_t base;
+      } u_control_code1_detected;
+      u_control_code1_detected.real = this->control_code1_detected;
+      *(outbuffer + offset + 0) = (u_control_code1_detected.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->control_code1_detected);
+      union {
+        bool real;
+        uint8_t base;
+      } u_control_code2_detected;
+      u_control_code2_detected.real = this->control_code2_detected;
+      *(outbuffer + offset + 0) = (u_control_code2_detected.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->control_code2_detected);
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      offset += this->header.deserialize(inbuffer + offset);
+      union {
+        float real;
+        uint32_t base;
+      } u_angle;
+      u_angle.base = 0;
+      u_angle.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_angle.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_angle.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_angle.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->angle = u_angle.real;
+      offset += sizeof(this->angle);
+      union {
+        float real;
+        uint32_t base;
+      } u_x_pos;
+      u_x_pos.base = 0;
+      u_x_pos.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_x_pos.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_x_pos.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_x_pos.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->x_pos = u_x_pos.real;
+      offset += sizeof(this->x_pos);
+      union {
+        float real;
+        uint32_t base;
+      } u_y_pos;
+      u_y_pos.base = 0;
+      u_y_pos.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_y_pos.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_y_pos.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_y_pos.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->y_pos = u_y_pos.real;
+      offset += sizeof(this->y_pos);
+      this->color_lane_count =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->color_lane_count);
+      union {
+        bool real;
+        uint8_t base;
+      } u_no_color_lane;
+      u_no_color_lane.base = 0;
+      u_no_color_lane.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->no_color_lane = u_no_color_lane.real;
+      offset += sizeof(this->no_color_lane);
+      union {
+        bool real;
+        uint8_t base;
+      } u_no_pos;
+      u_no_pos.base = 0;
+      u_no_pos.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->no_pos = u_no_pos.real;
+      offset += sizeof(this->no_pos);
+      union {
+        bool real;
+        uint8_t base;
+      } u_tag_detected;
+      u_tag_detected.base = 0;
+      u_tag_detected.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->tag_detected = u_tag_detected.real;
+      offset += sizeof(this->tag_detected);
+      union {
+        bool real;
+        uint8_t base;
+      } u_control_code1_detected;
+      u_control_code1_detected.base = 0;
+      u_control_code1_detected.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->control_code1_detected = u_control_code1_detected.real;
+      offset += sizeof(this->control_code1_detected);
+      union {
+        bool real;
+        uint8_t base;
+      } u_control_code2_detected;
+      u_control_code2_detected.base = 0;
+      u_control_code2_detected.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->control_code2_detected = u_control_code2_detected.real;
+      offset += sizeof(this->control_code2_detected);
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/PositionGuideVisionStamped"; };
+    virtual const char * getMD5() override { return "68803222a318999a0cee16786bb114f3"; };
+
+  };
+
+}
+#endif
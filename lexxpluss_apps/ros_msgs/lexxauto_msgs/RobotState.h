@@ -0,0 +1,586 @@
+#ifndef _ROS_lexxauto_msgs_RobotState_h
+#define _ROS_lexxauto_msgs_RobotState_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+#include "std_msgs/Header.h"
+
+namespace lexxauto_msgs
+{
+
+  class RobotState : public ros::Msg
+  {
+    public:
+      typedef std_msgs::Header _header_type;
+      _header_type header;
+      typedef uint8_t _updated_type;
+      _updated_type updated;
+      typedef uint8_t _fan_type;
+      _fan_type fan;
+      int8_t bumper[2];
+      typedef bool _emergency_switch_type;
+      _emergency_switch_type emergency_switch;
+      typedef int8_t _charge_status_type;
+      _charge_status_type charge_status;
+      typedef int8_t _power_state_type;
+      _power_state_type power_state;
+      typedef uint8_t _charge_heartbeat_delay_type;
+      _charge_heartbeat_delay_type charge_heartbeat_delay;
+      typedef float _charge_connector_voltage_type;
+      _charge_connector_voltage_type charge_connector_voltage;
+      float temperature[7];
+      typedef float _battery_voltage_type;
+      _battery_voltage_type battery_voltage;
+      typedef float _battery_current_type;
+      _battery_current_type battery_current;
+      typedef float _battery_charge_type;
+      _battery_charge_type battery_charge;
+      typedef float _battery_capacity_type;
+      _battery_capacity_type battery_capacity;
+      typedef float _battery_design_capacity_type;
+      _battery_design_capacity_type battery_design_capacity;
+      typedef float _battery_percentage_type;
+      _battery_percentage_type battery_percentage;
+      float battery_cell_voltage[2];
+      float battery_temperature[3];
+      typedef uint8_t _battery_status_type;
+      _battery_status_type battery_status;
+      typedef uint8_t _battery_health_type;
+      _battery_health_type battery_health;
+      typedef uint8_t _battery_state_of_health_type;
+      _battery_state_of_health_type battery_state_of_health;
+      typedef uint16_t _battery_serial_type;
+      _battery_serial_type battery_serial;
+      float ultrasonic[5];
+      float downward[2];
+      int32_t encoder_count[3];
+      typedef float _shelf_connection_type;
+      _shelf_connection_type shelf_connection;
+      float linear_actuator_current[3];
+      enum { BOARD = 1 };
+      enum { BATTERY = 2 };
+      enum { ULTRASONIC = 4 };
+      enum { DOWNWARD = 8 };
+      enum { ACTUATOR = 16 };
+
+    RobotState():
+      header(),
+      updated(),
+      fan(),
+      bumper(),
+      emergency_switch(),
+      charge_status(),
+      power_state(),
+      charge_heartbeat_delay(),
+      charge_connector_voltage(),
+      temperature(),
+      battery_voltage(),
+      battery_current(),
+      battery_charge(),
+      battery_capacity(),
+      battery_design_capacity(),
+      battery_percentage(),
+      battery_cell_voltage(),
+      battery_temperature(),
+      battery_status(),
+      battery_health(),
+      battery_state_of_health(),
+      battery_serial(),
+      ultrasonic(),
+      downward(),
+      encoder_count(),
+      shelf_connection(),
+      linear_actuator_current()
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      offset += this->header.serialize(outbuffer + offset);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_updated;
+      u_updated.real = this->updated;
+      *(outbuffer + offset + 0) = (u_updated.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->updated);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_fan;
+      u_fan.real = this->fan;
+      *(outbuffer + offset + 0) = (u_fan.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->fan);
+      for( uint32_t i = 0; i < 2; i++){
+      union {
+        int8_t real;
+        uint8_t base;
+      } u_bumperi;
+      u_bumperi.real = this->bumper[i];
+      *(outbuffer + offset + 0) = (u_bumperi.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->bumper[i]);
+      }
+      union {
+        bool real;
+        uint8_t base;
+      } u_emergency_switch;
+      u_emergency_switch.real = this->emergency_switch;
+      *(outbuffer + offset + 0) = (u_emergency_switch.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->emergency_switch);
+      union {
+        int8_t real;
+        uint8_t base;
+      } u_charge_status;
+      u_charge_status.real = this->charge_status;
+      *(outbuffer + offset + 0) = (u_charge_status.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->charge_status);
+      union {
+        int8_t real;
+        uint8_t base;
+      } u_power_state;
+      u_power_state.real = this->power_state;
+      *(outbuffer + offset + 0) = (u_power_state.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->power_state);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_charge_heartbeat_delay;
+      u_charge_heartbeat_delay.real = this->charge_heartbeat_delay;
+      *(outbuffer + offset + 0) = (u_charge_heartbeat_delay.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->charge_heartbeat_delay);
+      union {
+        float real;
+        uint32_t base;
+      } u_charge_connector_voltage;
+      u_charge_connector_voltage.real = this->charge_connector_voltage;
+      *(outbuffer + offset + 0) = (u_charge_connector_voltage.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_charge_connector_voltage.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_charge_connector_voltage.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_charge_connector_voltage.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->charge_connector_voltage);
+      for( uint32_t i = 0; i < 7; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_temperaturei;
+      u_temperaturei.real = this->temperature[i];
+      *(outbuffer + offset + 0) = (u_temperaturei.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_temperaturei.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_temperaturei.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_temperaturei.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->temperature[i]);
+      }
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_voltage;
+      u_battery_voltage.real = this->battery_voltage;
+      *(outbuffer + offset + 0) = (u_battery_voltage.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_voltage.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_voltage.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_voltage.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_voltage);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_current;
+      u_battery_current.real = this->battery_current;
+      *(outbuffer + offset + 0) = (u_battery_current.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_current.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_current.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_current.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_current);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_charge;
+      u_battery_charge.real = this->battery_charge;
+      *(outbuffer + offset + 0) = (u_battery_charge.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_charge.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_charge.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_charge.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_charge);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_capacity;
+      u_battery_capacity.real = this->battery_capacity;
+      *(outbuffer + offset + 0) = (u_battery_capacity.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_capacity.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_capacity.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_capacity.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_capacity);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_design_capacity;
+      u_battery_design_capacity.real = this->battery_design_capacity;
+      *(outbuffer + offset + 0) = (u_battery_design_capacity.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_design_capacity.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_design_capacity.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_design_capacity.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_design_capacity);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_percentage;
+      u_battery_percentage.real = this->battery_percentage;
+      *(outbuffer + offset + 0) = (u_battery_percentage.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_percentage.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_percentage.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_percentage.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_percentage);
+      for( uint32_t i = 0; i < 2; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_cell_voltagei;
+      u_battery_cell_voltagei.real = this->battery_cell_voltage[i];
+      *(outbuffer + offset + 0) = (u_battery_cell_voltagei.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_cell_voltagei.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_cell_voltagei.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_cell_voltagei.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_cell_voltage[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_temperaturei;
+      u_battery_temperaturei.real = this->battery_temperature[i];
+      *(outbuffer + offset + 0) = (u_battery_temperaturei.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_battery_temperaturei.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_battery_temperaturei.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_battery_temperaturei.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->battery_temperature[i]);
+      }
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_battery_status;
+      u_battery_status.real = this->battery_status;
+      *(outbuffer + offset + 0) = (u_battery_status.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->battery_status);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_battery_health;
+      u_battery_health.real = this->battery_health;
+      *(outbuffer + offset + 0) = (u_battery_health.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->battery_health);
+      union {
+        uint8_t real;
+        uint8_t base;
+      } u_battery_state_of_health;
+      u_battery_state_of_health.real = this->battery_state_of_health;
+      *(outbuffer + offset + 0) = (u_battery_state_of_health.base >> (8 * 0)) & 0xFF;
+      offset += sizeof(this->battery_state_of_health);
+      *(outbuffer + offset + 0) = (this->battery_serial >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->battery_serial >> (8 * 1)) & 0xFF;
+      offset += sizeof(this->battery_serial);
+      for( uint32_t i = 0; i < 5; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_ultrasonici;
+      u_ultrasonici.real = this->ultrasonic[i];
+      *(outbuffer + offset + 0) = (u_ultrasonici.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_ultrasonici.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_ultrasonici.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_ultrasonici.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->ultrasonic[i]);
+      }
+      for( uint32_t i = 0; i < 2; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_downwardi;
+      u_downwardi.real = this->downward[i];
+      *(outbuffer + offset + 0) = (u_downwardi.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_downwardi.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_downwardi.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_downwardi.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->downward[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        int32_t real;
+        uint32_t base;
+      } u_encoder_counti;
+      u_encoder_counti.real = this->encoder_count[i];
+      *(outbuffer + offset + 0) = (u_encoder_counti.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_encoder_counti.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_encoder_counti.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_encoder_counti.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->encoder_count[i]);
+      }
+      union {
+        float real;
+        uint32_t base;
+      } u_shelf_connection;
+      u_shelf_connection.real = this->shelf_connection;
+      *(outbuffer + offset + 0) = (u_shelf_connection.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_shelf_connection.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_shelf_connection.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_shelf_connection.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->shelf_connection);
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_linear_actuator_currenti;
+      u_linear_actuator_currenti.real = this->linear_actuator_current[i];
+      *(outbuffer + offset + 0) = (u_linear_actuator_currenti.base >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (u_linear_actuator_currenti.base >> (8 * 1)) & 0xFF;
+      *(outbuffer + offset + 2) = (u_linear_actuator_currenti.base >> (8 * 2)) & 0xFF;
+      *(outbuffer + offset + 3) = (u_linear_actuator_currenti.base >> (8 * 3)) & 0xFF;
+      offset += sizeof(this->linear_actuator_current[i]);
+      }
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      offset += this->header.deserialize(inbuffer + offset);
+      this->updated =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->updated);
+      this->fan =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->fan);
+      for( uint32_t i = 0; i < 2; i++){
+      union {
+        int8_t real;
+        uint8_t base;
+      } u_bumperi;
+      u_bumperi.base = 0;
+      u_bumperi.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->bumper[i] = u_bumperi.real;
+      offset += sizeof(this->bumper[i]);
+      }
+      union {
+        bool real;
+        uint8_t base;
+      } u_emergency_switch;
+      u_emergency_switch.base = 0;
+      u_emergency_switch.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->emergency_switch = u_emergency_switch.real;
+      offset += sizeof(this->emergency_switch);
+      union {
+        int8_t real;
+        uint8_t base;
+      } u_charge_status;
+      u_charge_status.base = 0;
+      u_charge_status.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->charge_status = u_charge_status.real;
+      offset += sizeof(this->charge_status);
+      union {
+        int8_t real;
+        uint8_t base;
+      } u_power_state;
+      u_power_state.base = 0;
+      u_power_state.base |= ((uint8_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      this->power_state = u_power_state.real;
+      offset += sizeof(this->power_state);
+      this->charge_heartbeat_delay =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->charge_heartbeat_delay);
+      union {
+        float real;
+        uint32_t base;
+      } u_charge_connector_voltage;
+      u_charge_connector_voltage.base = 0;
+      u_charge_connector_voltage.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_charge_connector_voltage.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_charge_connector_voltage.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_charge_connector_voltage.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->charge_connector_voltage = u_charge_connector_voltage.real;
+      offset += sizeof(this->charge_connector_voltage);
+      for( uint32_t i = 0; i < 7; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_temperaturei;
+      u_temperaturei.base = 0;
+      u_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->temperature[i] = u_temperaturei.real;
+      offset += sizeof(this->temperature[i]);
+      }
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_voltage;
+      u_battery_voltage.base = 0;
+      u_battery_voltage.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_voltage.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_voltage.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_voltage.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_voltage = u_battery_voltage.real;
+      offset += sizeof(this->battery_voltage);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_current;
+      u_battery_current.base = 0;
+      u_battery_current.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_current.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_current.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_current.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_current = u_battery_current.real;
+      offset += sizeof(this->battery_current);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_charge;
+      u_battery_charge.base = 0;
+      u_battery_charge.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_charge.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_charge.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_charge.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_charge = u_battery_charge.real;
+      offset += sizeof(this->battery_charge);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_capacity;
+      u_battery_capacity.base = 0;
+      u_battery_capacity.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_capacity.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_capacity.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_capacity.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_capacity = u_battery_capacity.real;
+      offset += sizeof(this->battery_capacity);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_design_capacity;
+      u_battery_design_capacity.base = 0;
+      u_battery_design_capacity.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_design_capacity.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_design_capacity.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_design_capacity.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_design_capacity = u_battery_design_capacity.real;
+      offset += sizeof(this->battery_design_capacity);
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_percentage;
+      u_battery_percentage.base = 0;
+      u_battery_percentage.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_percentage.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_percentage.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_percentage.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_percentage = u_battery_percentage.real;
+      offset += sizeof(this->battery_percentage);
+      for( uint32_t i = 0; i < 2; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_cell_voltagei;
+      u_battery_cell_voltagei.base = 0;
+      u_battery_cell_voltagei.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_cell_voltagei.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_cell_voltagei.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_cell_voltagei.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_cell_voltage[i] = u_battery_cell_voltagei.real;
+      offset += sizeof(this->battery_cell_voltage[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_battery_temperaturei;
+      u_battery_temperaturei.base = 0;
+      u_battery_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_battery_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_battery_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_battery_temperaturei.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->battery_temperature[i] = u_battery_temperaturei.real;
+      offset += sizeof(this->battery_temperature[i]);
+      }
+      this->battery_status =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->battery_status);
+      this->battery_health =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->battery_health);
+      this->battery_state_of_health =  ((uint8_t) (*(inbuffer + offset)));
+      offset += sizeof(this->battery_state_of_health);
+      this->battery_serial =  ((uint16_t) (*(inbuffer + offset)));
+      this->battery_serial |= ((uint16_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      offset += sizeof(this->battery_serial);
+      for( uint32_t i = 0; i < 5; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_ultrasonici;
+      u_ultrasonici.base = 0;
+      u_ultrasonici.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_ultrasonici.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_ultrasonici.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_ultrasonici.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->ultrasonic[i] = u_ultrasonici.real;
+      offset += sizeof(this->ultrasonic[i]);
+      }
+      for( uint32_t i = 0; i < 2; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_downwardi;
+      u_downwardi.base = 0;
+      u_downwardi.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_downwardi.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_downwardi.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_downwardi.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->downward[i] = u_downwardi.real;
+      offset += sizeof(this->downward[i]);
+      }
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        int32_t real;
+        uint32_t base;
+      } u_encoder_counti;
+      u_encoder_counti.base = 0;
+      u_encoder_counti.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_encoder_counti.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_encoder_counti.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_encoder_counti.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->encoder_count[i] = u_encoder_counti.real;
+      offset += sizeof(this->encoder_count[i]);
+      }
+      union {
+        float real;
+        uint32_t base;
+      } u_shelf_connection;
+      u_shelf_connection.base = 0;
+      u_shelf_connection.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_shelf_connection.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_shelf_connection.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_shelf_connection.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->shelf_connection = u_shelf_connection.real;
+      offset += sizeof(this->shelf_connection);
+      for( uint32_t i = 0; i < 3; i++){
+      union {
+        float real;
+        uint32_t base;
+      } u_linear_actuator_currenti;
+      u_linear_actuator_currenti.base = 0;
+      u_linear_actuator_currenti.base |= ((uint32_t) (*(inbuffer + offset + 0))) << (8 * 0);
+      u_linear_actuator_currenti.base |= ((uint32_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      u_linear_actuator_currenti.base |= ((uint32_t) (*(inbuffer + offset + 2))) << (8 * 2);
+      u_linear_actuator_currenti.base |= ((uint32_t) (*(inbuffer + offset + 3))) << (8 * 3);
+      this->linear_actuator_current[i] = u_linear_actuator_currenti.real;
+      offset += sizeof(this->linear_actuator_current[i]);
+      }
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/RobotState"; };
+    virtual const char * getMD5() override { return "c2e5885802602939fa97104c1e06599f"; };
+
+  };
+
+}
+#endif
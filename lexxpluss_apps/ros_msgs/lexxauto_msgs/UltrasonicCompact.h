@@ -0,0 +1,50 @@
+#ifndef _ROS_lexxauto_msgs_UltrasonicCompact_h
+#define _ROS_lexxauto_msgs_UltrasonicCompact_h
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ros/msg.h"
+
+namespace lexxauto_msgs
+{
+
+  class UltrasonicCompact : public ros::Msg
+  {
+    public:
+      uint16_t range_mm[5];
+
+    UltrasonicCompact():
+      range_mm()
+    {
+    }
+
+    virtual int serialize(unsigned char *outbuffer) const override
+    {
+      int offset = 0;
+      for( uint32_t i = 0; i < 5; i++){
+      *(outbuffer + offset + 0) = (this->range_mm[i] >> (8 * 0)) & 0xFF;
+      *(outbuffer + offset + 1) = (this->range_mm[i] >> (8 * 1)) & 0xFF;
+      offset += sizeof(this->range_mm[i]);
+      }
+      return offset;
+    }
+
+    virtual int deserialize(unsigned char *inbuffer) override
+    {
+      int offset = 0;
+      for( uint32_t i = 0; i < 5; i++){
+      this->range_mm[i] =  ((uint16_t) (*(inbuffer + offset)));
+      this->range_mm[i] |= ((uint16_t) (*(inbuffer + offset + 1))) << (8 * 1);
+      offset += sizeof(this->range_mm[i]);
+      }
+      return offset;
+    }
+
+    virtual const char * getType() override { return "lexxauto_msgs/UltrasonicCompact"; };
+    virtual const char * getMD5() override { return "56ea62f83cd9d15b64ef9cba0abd3c03"; };
+
+  };
+
+}
+#endif
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <iterator>
 #include <tuple>
 #include "actuator_controller.hpp"
 #include "adc_reader.hpp"
@@ -74,8 +75,8 @@ namespace lexxhard::actuator_controller {
 
 LOG_MODULE_REGISTER(actuator);
 
-char __aligned(4) msgq_buffer[8 * sizeof (msg)];
 char __aligned(4) msgq_control_buffer[8 * sizeof (msg_control)];
+char __aligned(4) msgq_job_status_buffer[8 * sizeof (msg_job_status)];
 
 static constexpr uint32_t ACTUATOR_NUM{3};
 
@@ -87,6 +88,15 @@ struct msg_pwmtrampoline {
 };
 K_MSGQ_DEFINE(msgq_pwmtrampoline, sizeof (msg_pwmtrampoline), 8, 4);
 
+struct msg_job {
+    uint32_t id{0};
+    uint8_t type{msg_job_status::INIT};
+    int8_t directions[ACTUATOR_NUM]{msg_control::STOP, msg_control::STOP, msg_control::STOP};
+    uint8_t location[ACTUATOR_NUM]{0, 0, 0}, power[ACTUATOR_NUM]{0, 0, 0};
+    bool wait{false};
+};
+K_MSGQ_DEFINE(msgq_job, sizeof (msg_job), 4, 4);
+
 enum class POS {
     LEFT, CENTER, RIGHT
 };
@@ -416,8 +426,10 @@ private:
 class actuator_controller_impl {
 public:
     int init() {
-        k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
         k_msgq_init(&msgq_control, msgq_control_buffer, sizeof (msg_control), 8);
+        k_msgq_init(&msgq_job_status, msgq_job_status_buffer, sizeof (msg_job_status), 8);
+        k_sem_init(&job_done, 0, 1);
+        k_mutex_init(&job_waiter);
         if (act[0].init(POS::LEFT) != 0 ||
             act[1].init(POS::CENTER) != 0 ||
             act[2].init(POS::RIGHT) != 0)
@@ -462,21 +474,35 @@ public:
             act[i].reset();
         uint32_t prev_cycle{k_cycle_get_32()};
         while (true) {
+            // A switch change in frame 0x200 wakes this loop from the CAN
+            // interrupt, so the stop comes before anything else.
+            can_controller::msg_state state;
+            can_controller::get_state(state);
+            uint32_t safety_cycle;
+            bool safety_stop{can_controller::get_safety_stop(safety_cycle)};
+            bool is_emergency{state.is_emergency() || safety_stop};
+            if (is_emergency)
+                pwm_direct_all(msg_control::STOP);
+            if (safety_stop && safety_cycle != prev_safety_cycle) {
+                prev_safety_cycle = safety_cycle;
+                count_stop_latency(safety_cycle);
+            }
             for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
                 act[i].poll();
-            bool is_emergency{can_controller::is_emergency()};
             msg_control ros2actuator;
             if (k_msgq_get(&msgq_control, &ros2actuator, K_NO_WAIT) == 0 && !is_emergency)
                 handle_control(ros2actuator);
             msg_pwmtrampoline pwmtrampoline;
             if (k_msgq_get(&msgq_pwmtrampoline, &pwmtrampoline, K_NO_WAIT) == 0 && !is_emergency)
                 handle_pwmtrampoline(pwmtrampoline);
+            poll_job(is_emergency);
             if (is_emergency)
                 pwm_direct_all(msg_control::STOP);
             uint32_t now_cycle{k_cycle_get_32()};
             uint32_t dt_ms{k_cyc_to_ms_near32(now_cycle - prev_cycle)};
             if (dt_ms > 20) {
                 prev_cycle = now_cycle;
+                actuator2ros.cycle = now_cycle;
                 bool failed{false};
                 for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
                     int8_t direction;
@@ -491,52 +517,40 @@ public:
                 }
                 fail_check(failed);
                 actuator2ros.connect = adc_reader::get(adc_reader::TROLLEY);
-                while (k_msgq_put(&msgq, &actuator2ros, K_NO_WAIT) != 0)
-                    k_msgq_purge(&msgq);
+                chan.publish(actuator2ros);
                 if (device_is_ready(gpiog)) {
                     gpio_pin_set(gpiog, 5, heartbeat_led);
                     heartbeat_led = !heartbeat_led;
                 }
             }
-            k_msleep(10);
+            k_sem_take(&can_controller::sem_safety, K_MSEC(10));
         }
     }
     int init_location(const int8_t (&directions)[ACTUATOR_NUM]) {
-        LOG_INF("initialize location.");
-        location_initialized = false;
-        constexpr uint8_t powers[ACTUATOR_NUM]{100, 100, 100};
-        control_trampoline(directions, powers);
-        bool stopped{wait_actuator_stop(30000, 100)};
-        pwm_trampoline_all(msg_control::STOP);
-        if (!stopped || can_controller::is_emergency()) {
-            LOG_WRN("can not initialize location.");
-            return -1;
-        }
-        for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
-            if (directions[i] == msg_control::UP || directions[i] == msg_control::DOWN) {
-                act[i].reset();
-            }
-        }
-        location_initialized = true;
-        return 0;
+        msg_job job{.type{msg_job_status::INIT}};
+        std::copy(std::begin(directions), std::end(directions), job.directions);
+        msg_job_status result;
+        return wait_job(job, result);
     }
     int to_location(const uint8_t (&location)[ACTUATOR_NUM], const uint8_t (&power)[ACTUATOR_NUM], uint8_t (&detail)[ACTUATOR_NUM]) {
-        LOG_INF("move location.");
-        if (!location_initialized) {
-            for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
-                detail[i] = 3;
-            LOG_WRN("location not initialized.");
-            return -1;
-        }
-        for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
-            act[i].to_location(location[i], power[i]);
-        bool stopped{wait_actuator_stop(30000, 100)};
-        pwm_trampoline_all(msg_control::STOP);
-        if (!stopped || can_controller::is_emergency()) {
-            LOG_WRN("unable to move location.");
-            return -1;
-        }
-        return 0;
+        msg_job job{.type{msg_job_status::LOCATION}};
+        std::copy(std::begin(location), std::end(location), job.location);
+        std::copy(std::begin(power), std::end(power), job.power);
+        msg_job_status result;
+        int ret{wait_job(job, result)};
+        std::copy(std::begin(result.detail), std::end(result.detail), detail);
+        return ret;
+    }
+    uint32_t start_init_location(const int8_t (&directions)[ACTUATOR_NUM]) {
+        msg_job job{.type{msg_job_status::INIT}};
+        std::copy(std::begin(directions), std::end(directions), job.directions);
+        return submit_job(job);
+    }
+    uint32_t start_to_location(const uint8_t (&location)[ACTUATOR_NUM], const uint8_t (&power)[ACTUATOR_NUM]) {
+        msg_job job{.type{msg_job_status::LOCATION}};
+        std::copy(std::begin(location), std::end(location), job.location);
+        std::copy(std::begin(power), std::end(power), job.power);
+        return submit_job(job);
     }
     void set_current_monitor() const {
     }
@@ -547,6 +561,10 @@ public:
                         "actuator: %d encoder: %d pulse current: %d mV fail: %d dir: %d duty: %u",
                         i, pulse, current, fail, direction, duty);
         }
+        shell_print(shell, "emergency frame to PWM stop: %u samples avg: %u us max: %u us",
+                    stop_latency_samples,
+                    stop_latency_samples == 0 ? 0 : stop_latency_sum_us / stop_latency_samples,
+                    stop_latency_max_us);
     }
     void pwm_trampoline(int index, int direction, uint8_t pwm_duty = 0) const {
         msg_pwmtrampoline message;
@@ -557,15 +575,6 @@ public:
         while (k_msgq_put(&msgq_pwmtrampoline, &message, K_NO_WAIT) != 0)
             k_msgq_purge(&msgq_pwmtrampoline);
     }
-    void control_trampoline(const int8_t (&directions)[ACTUATOR_NUM], const uint8_t (&powers)[ACTUATOR_NUM]) {
-        msg_control message;
-        for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
-            message.actuators[i].direction = directions[i];
-            message.actuators[i].power = powers[i];
-        }
-        while (k_msgq_put(&msgq_control, &message, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq_control);
-    }
     // void set_param(float pp, float vp, float vi) {
     //     for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
     //         act[i].set_param(pp, vp, vi);
@@ -581,37 +590,150 @@ private:
         else
             act[msg.index].direct(msg.direction, msg.duty);
     }
+    void count_stop_latency(uint32_t cycle) {
+        uint32_t us{k_cyc_to_us_floor32(k_cycle_get_32() - cycle)};
+        stop_latency_sum_us += us;
+        if (stop_latency_max_us < us)
+            stop_latency_max_us = us;
+        ++stop_latency_samples;
+    }
     void pwm_direct_all(int direction, uint8_t pwm_duty = 0) {
         for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
             act[i].direct(direction, pwm_duty);
     }
-    void pwm_trampoline_all(int direction, uint8_t pwm_duty = 0) const {
-        msg_pwmtrampoline message;
-        message.all = true;
-        message.direction = direction;
-        message.duty = pwm_duty;
-        while (k_msgq_put(&msgq_pwmtrampoline, &message, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq_pwmtrampoline);
+    uint32_t submit_job(msg_job &job) {
+        job.id = static_cast<uint32_t>(atomic_inc(&job_id)) + 1;
+        return k_msgq_put(&msgq_job, &job, K_NO_WAIT) == 0 ? job.id : 0;
+    }
+    // Waiters (shell, sync services) take turns. A job that outlives the
+    // wait still completes, its late result is told apart by the id.
+    int wait_job(msg_job &job, msg_job_status &result) {
+        result = msg_job_status{};
+        result.state = msg_job_status::FAILED;
+        k_mutex_lock(&job_waiter, K_FOREVER);
+        int ret{wait_job_locked(job, result)};
+        k_mutex_unlock(&job_waiter);
+        return ret;
+    }
+    int wait_job_locked(msg_job &job, msg_job_status &result) {
+        k_sem_reset(&job_done);
+        job.wait = true;
+        uint32_t id{submit_job(job)};
+        if (id == 0)
+            return -1;
+        result.id = id;
+        int64_t deadline{k_uptime_get() + JOB_TIMEOUT_MS + JOB_WAIT_MARGIN_MS};
+        while (true) {
+            int64_t remain_ms{deadline - k_uptime_get()};
+            if (remain_ms <= 0 || k_sem_take(&job_done, K_MSEC(remain_ms)) != 0) {
+                LOG_WRN("job %u timed out.", id);
+                return -1;
+            }
+            if (job_result.id == id)
+                break;
+        }
+        result = job_result;
+        return result.state == msg_job_status::SUCCEEDED ? 0 : -1;
+    }
+    void poll_job(bool is_emergency) {
+        if (!job_running) {
+            if (k_msgq_get(&msgq_job, &job, K_NO_WAIT) == 0)
+                start_job(is_emergency);
+            return;
+        }
+        // Same checks as the former blocking wait, one step every JOB_STEP_MS
+        // without holding the caller: actuators still at rest after the first
+        // few steps are done.
+        uint32_t elapsed_ms{k_cyc_to_ms_floor32(k_cycle_get_32() - job_cycle)};
+        if (elapsed_ms < job_step * JOB_STEP_MS)
+            return;
+        uint8_t moving{ACTUATOR_NUM};
+        for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
+            if (job_step >= JOB_SETTLE_STEPS && !act[i].is_moving()) {
+                act[i].direct(msg_control::STOP, 0);
+                --moving;
+            }
+        }
+        job_status.elapsed_ms = elapsed_ms;
+        job_status.moving = moving;
+        if (moving == 0)
+            finish_job(!is_emergency);
+        else if (++job_step >= JOB_TIMEOUT_MS / JOB_STEP_MS)
+            finish_job(false);
+        else if (job_step % (JOB_REPORT_MS / JOB_STEP_MS) == 0)
+            report_job(msg_job_status::RUNNING);
+    }
+    void start_job(bool is_emergency) {
+        job_running = true;
+        job_cycle = k_cycle_get_32();
+        job_step = 0;
+        job_status = msg_job_status{};
+        job_status.id = job.id;
+        job_status.type = job.type;
+        job_status.moving = ACTUATOR_NUM;
+        report_job(msg_job_status::ACCEPTED);
+        if (job.type == msg_job_status::INIT) {
+            LOG_INF("initialize location.");
+            location_initialized = false;
+            if (!is_emergency) {
+                for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
+                    act[i].direct(job.directions[i], 100);
+            }
+        } else {
+            LOG_INF("move location.");
+            if (!location_initialized) {
+                for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
+                    job_status.detail[i] = 3;
+                LOG_WRN("location not initialized.");
+                end_job(msg_job_status::FAILED);
+                return;
+            }
+            for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
+                act[i].to_location(job.location[i], job.power[i]);
+        }
     }
-    bool wait_actuator_stop(uint32_t timeout_ms, uint32_t sleep_ms) {
-        int remaining{3};
-        for (uint32_t i{0}, end{timeout_ms / sleep_ms}; i < end; ++i) {
-            remaining = 3;
-            for (uint32_t j{0}; j < ACTUATOR_NUM; ++j) {
-                if (i >= 4 && !act[j].is_moving()) {
-                    pwm_trampoline(j, msg_control::STOP);
-                    --remaining;
+    void finish_job(bool succeeded) {
+        pwm_direct_all(msg_control::STOP);
+        if (job.type == msg_job_status::INIT) {
+            if (succeeded) {
+                for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
+                    if (job.directions[i] == msg_control::UP || job.directions[i] == msg_control::DOWN)
+                        act[i].reset();
                 }
+                location_initialized = true;
+            } else {
+                LOG_WRN("can not initialize location.");
             }
-            if (remaining <= 0)
-                break;
-            k_msleep(sleep_ms);
+        } else if (!succeeded) {
+            LOG_WRN("unable to move location.");
         }
-        return remaining <= 0;
+        end_job(succeeded ? msg_job_status::SUCCEEDED : msg_job_status::FAILED);
+    }
+    void end_job(uint8_t state) {
+        report_job(state);
+        if (job.wait) {
+            job_result = job_status;
+            k_sem_give(&job_done);
+        }
+        job_running = false;
+    }
+    void report_job(uint8_t state) {
+        job_status.state = state;
+        while (k_msgq_put(&msgq_job_status, &job_status, K_NO_WAIT) != 0)
+            k_msgq_purge(&msgq_job_status);
     }
+    static constexpr uint32_t JOB_STEP_MS{100}, JOB_SETTLE_STEPS{4}, JOB_TIMEOUT_MS{30000}, JOB_REPORT_MS{500};
+    static constexpr uint32_t JOB_WAIT_MARGIN_MS{1000};
     msg actuator2ros;
     actuator act[3];
-    bool location_initialized{false};
+    msg_job job;
+    msg_job_status job_status, job_result;
+    k_sem job_done;
+    k_mutex job_waiter;
+    atomic_t job_id{ATOMIC_INIT(0)};
+    uint32_t job_cycle{0}, job_step{0};
+    uint32_t prev_safety_cycle{0}, stop_latency_samples{0}, stop_latency_sum_us{0}, stop_latency_max_us{0};
+    bool location_initialized{false}, job_running{false};
 } impl;
 
 int cmd_duty(const shell *shell, size_t argc, char **argv)
@@ -725,8 +847,19 @@ int to_location(const uint8_t (&location)[ACTUATOR_NUM], const uint8_t (&power)[
     return impl.to_location(location, power, detail);
 }
 
+uint32_t start_init_location(const int8_t (&directions)[ACTUATOR_NUM])
+{
+    return impl.start_init_location(directions);
+}
+
+uint32_t start_to_location(const uint8_t (&location)[ACTUATOR_NUM], const uint8_t (&power)[ACTUATOR_NUM])
+{
+    return impl.start_to_location(location, power);
+}
+
 k_thread thread;
-k_msgq msgq, msgq_control;
+channel<msg> chan{"actuator"};
+k_msgq msgq_control, msgq_job_status;
 
 }
 
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include "channel.hpp"
 
 namespace lexxhard::actuator_controller {
 
@@ -42,14 +43,27 @@ struct msg {
     int32_t current[3];
     int32_t connect;
     bool fail[3];
+    uint32_t cycle;
+} __attribute__((aligned(4)));
+
+struct msg_job_status {
+    uint32_t id;
+    uint32_t elapsed_ms;
+    uint8_t type, state, moving;
+    uint8_t detail[3];
+    static constexpr uint8_t INIT{0}, LOCATION{1};
+    static constexpr uint8_t ACCEPTED{0}, RUNNING{1}, SUCCEEDED{2}, FAILED{3};
 } __attribute__((aligned(4)));
 
 void init();
 void run(void *p1, void *p2, void *p3);
 int init_location(const int8_t (&directoins)[3]);
 int to_location(const uint8_t (&location)[3], const uint8_t (&power)[3], uint8_t (&detail)[3]);
+uint32_t start_init_location(const int8_t (&directions)[3]);
+uint32_t start_to_location(const uint8_t (&location)[3], const uint8_t (&power)[3]);
 extern k_thread thread;
-extern k_msgq msgq, msgq_control;
+extern channel<msg> chan;
+extern k_msgq msgq_control, msgq_job_status;
 
 }
 
@@ -24,6 +24,8 @@
  */
 
 #include <zephyr.h>
+#include <cstdlib>
+#include <cstring>
 #include <device.h>
 #include <drivers/can.h>
 #include <drivers/gpio.h>
@@ -33,6 +35,9 @@
 #include "led_controller.hpp"
 #include "misc_controller.hpp"
 #include "can_controller.hpp"
+#include "can_decoder.hpp"
+#include "can_monitor.hpp"
+#include "seqlock.hpp"
 
 
 #define QUOTE(name) #name
@@ -54,15 +59,147 @@ namespace lexxhard::can_controller {
 
 LOG_MODULE_REGISTER(can);
 
-char __aligned(4) msgq_bmu_buffer[8 * sizeof (msg_bmu)];
-char __aligned(4) msgq_board_buffer[8 * sizeof (msg_board)];
 char __aligned(4) msgq_control_buffer[8 * sizeof (msg_control)];
 char __aligned(4) msgq_diagnostics_buffer[8 * sizeof (msg_diagnostics)];
+char __aligned(4) msgq_switch_buffer[16 * sizeof (msg_switch)];
 
 CAN_DEFINE_MSGQ(msgq_can_bmu, 16);
 CAN_DEFINE_MSGQ(msgq_can_board, 4);
 CAN_DEFINE_MSGQ(msgq_can_log, 8);
 
+// Receive queue fed by an RX callback, which counts the frames that do not
+// fit instead of dropping them silently.
+struct rx_queue {
+    const char *name;
+    k_msgq *msgq;
+    uint16_t id;
+    uint32_t dropped;
+} rx_queues[]{
+    {"bmu",   &msgq_can_bmu,   0x100, 0},
+    {"board", &msgq_can_board, 0x200, 0},
+    {"log",   &msgq_can_log,   0x300, 0}
+};
+
+can_monitor stats;
+// The cycle of the last change with the stop flag in bit 0, so that both are
+// read together.
+atomic_t safety_state{ATOMIC_INIT(0)};
+
+void rx_callback(zcan_frame *frame, void *arg)
+{
+    auto queue{static_cast<rx_queue*>(arg)};
+    stats.received(frame->id, k_cycle_get_32());
+    if (k_msgq_put(queue->msgq, frame, K_NO_WAIT) != 0)
+        ++queue->dropped;
+}
+
+// The emergency and bumper switches of 0x200 are taken here already, so a
+// stop does not wait for the CAN thread to decode the frame.
+void rx_board_callback(zcan_frame *frame, void *arg)
+{
+    uint32_t cycle{k_cycle_get_32()};
+    if (frame->id == 0x200 && frame->dlc == 8) {
+        static constexpr uint8_t EMERGENCY_SWITCH{0b00000110}, BUMPER_SWITCH{0b00011000};
+        atomic_val_t stop{(frame->data[0] & (EMERGENCY_SWITCH | BUMPER_SWITCH)) != 0};
+        if ((atomic_get(&safety_state) & 1) != stop) {
+            atomic_set(&safety_state, static_cast<atomic_val_t>(cycle & ~1U) | stop);
+            k_sem_give(&sem_safety);
+        }
+    }
+    rx_callback(frame, arg);
+}
+
+namespace frames {
+
+using namespace can_decoder;
+
+#define BMU(member) offsetof(msg_bmu, member)
+#define BOARD(member) offsetof(msg_board, member)
+
+constexpr field bmu_fields[]{
+    u8  (0x100, 7, 0, type::U8,  BMU(mod_status1)),
+    u8  (0x100, 7, 1, type::U8,  BMU(bmu_status)),
+    u8  (0x100, 7, 2, type::U8,  BMU(asoc)),
+    u8  (0x100, 7, 3, type::U8,  BMU(rsoc)),
+    u8  (0x100, 7, 4, type::U8,  BMU(soh)),
+    be16(0x100, 7, 5, type::I16, BMU(fet_temp)),
+    be16(0x101, 7, 0, type::I16, BMU(pack_current)),
+    be16(0x101, 7, 2, type::U16, BMU(charging_current)),
+    be16(0x101, 7, 4, type::U16, BMU(pack_voltage)),
+    u8  (0x101, 7, 6, type::U8,  BMU(mod_status2)),
+    be16(0x103, 6, 0, type::U16, BMU(design_capacity)),
+    be16(0x103, 6, 2, type::U16, BMU(full_charge_capacity)),
+    be16(0x103, 6, 4, type::U16, BMU(remain_capacity)),
+    be16(0x110, 7, 0, type::U16, BMU(max_voltage.value)),
+    u8  (0x110, 7, 2, type::U8,  BMU(max_voltage.id)),
+    be16(0x110, 7, 4, type::U16, BMU(min_voltage.value)),
+    u8  (0x110, 7, 6, type::U8,  BMU(min_voltage.id)),
+    be16(0x111, 7, 0, type::I16, BMU(max_temp.value)),
+    u8  (0x111, 7, 2, type::U8,  BMU(max_temp.id)),
+    be16(0x111, 7, 4, type::I16, BMU(min_temp.value)),
+    u8  (0x111, 7, 6, type::U8,  BMU(min_temp.id)),
+    be16(0x112, 7, 0, type::I16, BMU(max_current.value)),
+    u8  (0x112, 7, 2, type::U8,  BMU(max_current.id)),
+    be16(0x112, 7, 4, type::I16, BMU(min_current.value)),
+    u8  (0x112, 7, 6, type::U8,  BMU(min_current.id)),
+    u8  (0x113, 6, 0, type::U8,  BMU(bmu_fw_ver)),
+    u8  (0x113, 6, 1, type::U8,  BMU(mod_fw_ver)),
+    u8  (0x113, 6, 2, type::U8,  BMU(serial_config)),
+    u8  (0x113, 6, 3, type::U8,  BMU(parallel_config)),
+    u8  (0x113, 6, 4, type::U8,  BMU(bmu_alarm1)),
+    u8  (0x113, 6, 5, type::U8,  BMU(bmu_alarm2)),
+    be16(0x120, 7, 0, type::U16, BMU(min_cell_voltage.value)),
+    u8  (0x120, 7, 2, type::U8,  BMU(min_cell_voltage.id)),
+    be16(0x120, 7, 4, type::U16, BMU(max_cell_voltage.value)),
+    u8  (0x120, 7, 6, type::U8,  BMU(max_cell_voltage.id)),
+    be16(0x130, 6, 0, type::U16, BMU(manufacturing)),
+    be16(0x130, 6, 2, type::U16, BMU(inspection)),
+    be16(0x130, 6, 4, type::U16, BMU(serial)),
+};
+
+// 0x202 and 0x203 carry no fields, the handler acts on them directly.
+constexpr field board_fields[]{
+    bits(0x200, 8, 0, 0b00001000, type::BOOL, BOARD(bumper_switch[0])),
+    bits(0x200, 8, 0, 0b00010000, type::BOOL, BOARD(bumper_switch[1])),
+    bits(0x200, 8, 0, 0b00000010, type::BOOL, BOARD(emergency_switch[0])),
+    bits(0x200, 8, 0, 0b00000100, type::BOOL, BOARD(emergency_switch[1])),
+    bits(0x200, 8, 0, 0b00000001, type::BOOL, BOARD(power_switch)),
+    bits(0x200, 8, 1, 0b10000000, type::BOOL, BOARD(wait_shutdown)),
+    bits(0x200, 8, 1, 0b00000010, type::BOOL, BOARD(auto_charging)),
+    bits(0x200, 8, 1, 0b01111100, type::U8,   BOARD(shutdown_reason)),
+    bits(0x200, 8, 1, 0b00000001, type::BOOL, BOARD(manual_charging)),
+    bits(0x200, 8, 2, 0b00010000, type::BOOL, BOARD(c_fet)),
+    bits(0x200, 8, 2, 0b00100000, type::BOOL, BOARD(d_fet)),
+    bits(0x200, 8, 2, 0b01000000, type::BOOL, BOARD(p_dsg)),
+    bits(0x200, 8, 2, 0b00000001, type::BOOL, BOARD(v5_fail)),
+    bits(0x200, 8, 2, 0b00000010, type::BOOL, BOARD(v16_fail)),
+    bits(0x200, 8, 3, 0b00000001, type::BOOL, BOARD(wheel_disable[0])),
+    bits(0x200, 8, 3, 0b00000010, type::BOOL, BOARD(wheel_disable[1])),
+    bits(0x200, 8, 3, 0b11111100, type::U8,   BOARD(state)),
+    u8  (0x200, 8, 4, type::U8,  BOARD(fan_duty)),
+    u8  (0x200, 8, 5, type::I16, BOARD(charge_connector_temp[0])),
+    u8  (0x200, 8, 6, type::I16, BOARD(charge_connector_temp[1])),
+    u8  (0x200, 8, 7, type::I16, BOARD(power_board_temp)),
+    frame(0x202, 1),
+    frame(0x203, 0),
+    le16(0x204, 5, 0, type::FLOAT, BOARD(charge_connector_voltage), 1e-3f),
+    u8  (0x204, 5, 2, type::U8,   BOARD(charge_check_count)),
+    u8  (0x204, 5, 3, type::U8,   BOARD(charge_heartbeat_delay)),
+    u8  (0x204, 5, 4, type::BOOL, BOARD(charge_temperature_error)),
+};
+
+#undef BMU
+#undef BOARD
+
+// Spans match the acceptance filters set up in setup_can_filter().
+constexpr decoder<msg_bmu, 0x100, 0x40, ARRAY_SIZE(bmu_fields)> bmu{bmu_fields};
+constexpr decoder<msg_board, 0x200, 0x08, ARRAY_SIZE(board_fields)> board{board_fields};
+static_assert(bmu.valid(), "BMU frame table");
+static_assert(board.valid(), "board frame table");
+static_assert(bmu.groups() == msg_bmu::FRAMES, "BMU frame groups");
+
+}
+
 class log_printer {
 public:
     void putc(char c) {
@@ -82,10 +219,13 @@ private:
 class can_controller_impl {
 public:
     int init() {
-        k_msgq_init(&msgq_bmu, msgq_bmu_buffer, sizeof (msg_bmu), 8);
-        k_msgq_init(&msgq_board, msgq_board_buffer, sizeof (msg_board), 8);
+        bmu2ros.stale = (1 << msg_bmu::FRAMES) - 1;
+        stats.reset();
+        update_state();
         k_msgq_init(&msgq_control, msgq_control_buffer, sizeof (msg_control), 8);
         k_msgq_init(&msgq_diagnostics, msgq_diagnostics_buffer, sizeof (msg_diagnostics), 8);
+        k_msgq_init(&msgq_switch, msgq_switch_buffer, sizeof (msg_switch), 16);
+        k_sem_init(&sem_safety, 0, 1);
         dev = device_get_binding("CAN_2");
         if (!device_is_ready(dev))
             return -1;
@@ -99,75 +239,94 @@ public:
         if (device_is_ready(gpiog))
             gpio_pin_configure(gpiog, 6, GPIO_OUTPUT_LOW | GPIO_ACTIVE_HIGH);
         setup_can_filter();
+        // Sleeps until a frame, a command or the send timer arrives.
+        k_poll_signal_init(&signal_send);
+        k_timer_init(&timer_send, [](k_timer *timer) {
+            k_poll_signal_raise(static_cast<k_poll_signal*>(k_timer_user_data_get(timer)), 0);
+        }, nullptr);
+        k_timer_user_data_set(&timer_send, &signal_send);
+        k_timer_start(&timer_send, K_NO_WAIT, K_NO_WAIT);
+        k_msgq *msgq[]{
+            &msgq_can_bmu,
+            &msgq_can_board,
+            &msgq_can_log,
+            &msgq_control,
+            &interlock_controller::msgq_can_interlock
+        };
+        k_poll_event events[ARRAY_SIZE(msgq) + 1];
+        for (uint32_t i{0}; i < ARRAY_SIZE(msgq); ++i)
+            k_poll_event_init(&events[i], K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, msgq[i]);
+        k_poll_event_init(&events[ARRAY_SIZE(msgq)], K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &signal_send);
         int heartbeat_led{1};
         while (true) {
-            bool handled{false};
+            k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+            for (auto &i : events)
+                i.state = K_POLL_STATE_NOT_READY;
             zcan_frame frame;
-            if (k_msgq_get(&msgq_can_bmu, &frame, K_NO_WAIT) == 0) {
-                bool is_corrupted{false};
-                if (handler_bmu(frame, is_corrupted)) {
-                    while (k_msgq_put(&msgq_bmu, &bmu2ros, K_NO_WAIT) != 0)
-                        k_msgq_purge(&msgq_bmu);
-                } else if(is_corrupted) {
+            while (k_msgq_get(&msgq_can_bmu, &frame, K_NO_WAIT) == 0) {
+                if (!handler_bmu(frame))
                     handler_corrupted_frame(frame);
-                }
-                handled = true;
             }
-            if (k_msgq_get(&msgq_can_board, &frame, K_NO_WAIT) == 0) {
+            check_bmu_stale();
+            check_link();
+            if (bmu_updated) {
+                chan_bmu.publish(bmu2ros);
+                bmu_updated = false;
+            }
+            while (k_msgq_get(&msgq_can_board, &frame, K_NO_WAIT) == 0) {
                 if (handler_board(frame)) {
-                    while (k_msgq_put(&msgq_board, &board2ros, K_NO_WAIT) != 0)
-                        k_msgq_purge(&msgq_board);
+                    chan_board.publish(board2ros);
                 } else {
                     handler_corrupted_frame(frame);
                 }
-                handled = true;
             }
-            if (k_msgq_get(&msgq_can_log, &frame, K_NO_WAIT) == 0) {
+            while (k_msgq_get(&msgq_can_log, &frame, K_NO_WAIT) == 0) {
                 handler_log(frame);
             }
-            if (k_msgq_get(&msgq_control, &ros2board, K_NO_WAIT) == 0) {
+            while (k_msgq_get(&msgq_control, &ros2board, K_NO_WAIT) == 0) {
                 prev_cycle_ros = k_cycle_get_32();
-                handled = true;
+                if (!request_pending) {
+                    request_cycle = ros2board.cycle;
+                    request_pending = true;
+                }
             }
             interlock_controller::msg_can_interlock message;
-            if (k_msgq_get(&interlock_controller::msgq_can_interlock, &message, K_NO_WAIT) == 0) {
+            while (k_msgq_get(&interlock_controller::msgq_can_interlock, &message, K_NO_WAIT) == 0) {
 	        ros2board.emergency_stop |= message.is_emergency_stop;
             }
-            uint32_t now_cycle{k_cycle_get_32()};
             if (prev_cycle_ros != 0) {
-                uint32_t dt_ms{k_cyc_to_ms_near32(now_cycle - prev_cycle_ros)};
+                uint32_t dt_ms{k_cyc_to_ms_near32(k_cycle_get_32() - prev_cycle_ros)};
                 heartbeat_timeout = dt_ms > 3000;
             }
-            uint32_t dt_ms{k_cyc_to_ms_near32(now_cycle - prev_cycle_send)};
-            if (dt_ms > 100) {
-                prev_cycle_send = now_cycle;
-                send_message();
-                if (device_is_ready(gpiog)) {
-                    gpio_pin_set(gpiog, 6, heartbeat_led);
-                    heartbeat_led = !heartbeat_led;
+            // The frame goes out as soon as its payload changes, but not
+            // within MIN_GAP_MS of the previous one, and is repeated after
+            // SEND_PERIOD_MS without a change as the keepalive.
+            build_message(frame);
+            bool changed{memcmp(frame.data, sent_data, sizeof sent_data) != 0};
+            unsigned int signaled;
+            int result;
+            k_poll_signal_check(&signal_send, &signaled, &result);
+            if (signaled != 0 || changed) {
+                uint32_t gap_ms{k_cyc_to_ms_floor32(k_cycle_get_32() - prev_cycle_send)};
+                if (signaled == 0 && gap_ms < MIN_GAP_MS) {
+                    k_timer_start(&timer_send, K_MSEC(MIN_GAP_MS - gap_ms), K_NO_WAIT);
+                } else {
+                    k_poll_signal_reset(&signal_send);
+                    // A frame that failed is retried after the gap, not with
+                    // the keepalive.
+                    bool sent{send_message(frame, changed)};
+                    k_timer_start(&timer_send, K_MSEC(sent ? SEND_PERIOD_MS : MIN_GAP_MS), K_NO_WAIT);
+                    if (device_is_ready(gpiog)) {
+                        gpio_pin_set(gpiog, 6, heartbeat_led);
+                        heartbeat_led = !heartbeat_led;
+                    }
                 }
             }
-            if (!handled)
-                k_msleep(1);
+            update_state();
         }
     }
-    uint32_t get_rsoc() const {
-        return bmu2ros.rsoc;
-    }
-    bool get_emergency_switch() const {
-        return board2ros.emergency_switch[0] ||
-               board2ros.emergency_switch[1];
-    }
-    bool get_bumper_switch() const {
-	return board2ros.bumper_switch[0] ||
-	       board2ros.bumper_switch[1];
-    }
-    bool is_emergency() const {
-        return board2ros.emergency_switch[0] ||
-               board2ros.emergency_switch[1] ||
-               board2ros.bumper_switch[0] ||
-               board2ros.bumper_switch[1] ||
-               ros2board.emergency_stop;
+    void get_state(msg_state &state) const {
+        snapshot.read(state);
     }
     void bmu_info(const shell *shell) const {
         shell_print(shell,
@@ -181,7 +340,8 @@ public:
                     "BMUFW:0x%02x MODFW:0x%02x SER:0x%02x PAR:0x%02x\n"
                     "ALM1:0x%02x ALM2:0x%02x\n"
                     "Max Cell Voltage:%u/%u Min Cell Voltage:%u/%u\n"
-                    "Manufacture:%u Inspection:%u Serial:%u\n",
+                    "Manufacture:%u Inspection:%u Serial:%u\n"
+                    "Decode:%u frames avg:%uns max:%uns\n",
                     bmu2ros.mod_status1, bmu2ros.mod_status2, bmu2ros.bmu_status,
                     bmu2ros.asoc, bmu2ros.rsoc, bmu2ros.soh,
                     bmu2ros.fet_temp, bmu2ros.pack_current, bmu2ros.charging_current,
@@ -192,7 +352,23 @@ public:
                     bmu2ros.bmu_fw_ver, bmu2ros.mod_fw_ver, bmu2ros.serial_config, bmu2ros.parallel_config,
                     bmu2ros.bmu_alarm1, bmu2ros.bmu_alarm2,
                     bmu2ros.max_cell_voltage.value, bmu2ros.max_cell_voltage.id, bmu2ros.min_cell_voltage.value, bmu2ros.min_cell_voltage.id,
-                    bmu2ros.manufacturing, bmu2ros.inspection, bmu2ros.serial);
+                    bmu2ros.manufacturing, bmu2ros.inspection, bmu2ros.serial,
+                    decode_frames,
+                    decode_frames == 0 ? 0 : k_cyc_to_ns_near32(static_cast<uint32_t>(decode_cycles / decode_frames)),
+                    k_cyc_to_ns_near32(decode_cycles_max));
+        uint32_t now{k_uptime_get_32()};
+        for (uint32_t i{0}; i < msg_bmu::FRAMES; ++i) {
+            if (bmu2ros.received_ms[i] == 0)
+                shell_print(shell, "0x%03x: never", frames::bmu.group_id(i));
+            else
+                shell_print(shell, "0x%03x: %ums ago%s", frames::bmu.group_id(i), now - bmu2ros.received_ms[i],
+                            (bmu2ros.stale & (1 << i)) != 0 ? " (stale)" : "");
+        }
+    }
+    void bmu_timeout(const shell *shell, int timeout_ms) {
+        if (timeout_ms >= 0)
+            bmu_stale_timeout_ms = timeout_ms;
+        shell_print(shell, "stale timeout: %ums%s", bmu_stale_timeout_ms, bmu_stale_timeout_ms == 0 ? " (disabled)" : "");
     }
     void brd_emgoff() {
         ros2board.emergency_stop = false;
@@ -230,7 +406,40 @@ public:
                     board2ros.charge_connector_voltage, board2ros.charge_check_count, board2ros.charge_heartbeat_delay, board2ros.charge_temperature_error,
                     version, version_powerboard);
     }
+    void can_stats(const shell *shell) const {
+        static constexpr const char *states[]{"error-active", "error-passive", "bus-off"};
+        uint32_t elapsed_ms{stats.get_elapsed_ms()};
+        shell_print(shell, "id     frames  rate/s  gap min/max us  gap histogram <1,1,2,4..512,1024+ ms");
+        stats.for_each([&](const can_monitor::id_stat &stat) {
+            char buf[80];
+            for (uint32_t i{0}, n{0}; i < can_monitor::BUCKETS && n < sizeof buf; ++i)
+                n += snprintf(buf + n, sizeof buf - n, " %u", stat.histogram[i]);
+            shell_print(shell, "0x%03x %7u %7u %7u/%u%s",
+                        stat.id, stat.frames,
+                        elapsed_ms == 0 ? 0 : static_cast<uint32_t>(static_cast<uint64_t>(stat.frames) * 1000 / elapsed_ms),
+                        stat.min_gap_us, stat.max_gap_us, buf);
+        });
+        if (stats.get_untracked() != 0)
+            shell_print(shell, "untracked frames: %u", stats.get_untracked());
+        for (const auto &i : rx_queues)
+            shell_print(shell, "queue %s: dropped %u", i.name, i.dropped);
+        shell_print(shell, "queue diagnostics: dropped %u", diagnostics_dropped);
+        shell_print(shell, "tx ok:%u fail:%u last error:%d", stats.get_tx_ok(), stats.get_tx_fail(), stats.get_tx_last_error());
+        auto latency{stats.get_request_latency()};
+        shell_print(shell, "ros request to tx: %u samples avg:%uus max:%uus",
+                    latency.samples, latency.samples == 0 ? 0 : latency.sum_us / latency.samples, latency.max_us);
+        can_bus_err_cnt err_cnt{0, 0};
+        can_state state{can_get_state(dev, &err_cnt)};
+        shell_print(shell, "state:%s tx errors:%u rx errors:%u bus-off:%u error-passive:%u recovered:%u",
+                    state < ARRAY_SIZE(states) ? states[state] : "unknown",
+                    err_cnt.tx_err_cnt, err_cnt.rx_err_cnt,
+                    stats.get_bus_off(), stats.get_error_passive(), stats.get_recovered());
+    }
+    void can_reset() {
+        stats.reset();
+    }
 private:
+    // can_monitor::RANGES lists the ids these filters pass.
     void setup_can_filter() const {
         static const zcan_filter filter_bmu{
             .id{0x100},
@@ -253,151 +462,48 @@ private:
             .id_mask{CAN_STD_ID_MASK},
             .rtr_mask{1}
         };
-        can_attach_msgq(dev, &msgq_can_bmu, &filter_bmu);
-        can_attach_msgq(dev, &msgq_can_board, &filter_board);
-        can_attach_msgq(dev, &msgq_can_log, &filter_log);
+        can_attach_isr(dev, rx_callback, &rx_queues[0], &filter_bmu);
+        can_attach_isr(dev, rx_board_callback, &rx_queues[1], &filter_board);
+        can_attach_isr(dev, rx_callback, &rx_queues[2], &filter_log);
+        can_register_state_change_isr(dev, [](can_state state, can_bus_err_cnt err_cnt) {
+            stats.state_changed(state, err_cnt);
+        });
     }
-    bool handler_bmu(zcan_frame &frame, bool &is_corrupted) {
-        bool result{false};
-        if (frame.id == 0x100) {
-            if (frame.dlc <= 6) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.mod_status1 = frame.data[0];
-            bmu2ros.bmu_status = frame.data[1];
-            bmu2ros.asoc = frame.data[2];
-            bmu2ros.rsoc = frame.data[3];
-            bmu2ros.soh = frame.data[4];
-            bmu2ros.fet_temp = (frame.data[5] << 8) | frame.data[6];
-        } else if (frame.id == 0x101) {
-            if (frame.dlc <= 6) {
-                LOG_ERR("0x101, dlc: %d", frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.pack_current = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.charging_current = (frame.data[2] << 8) | frame.data[3];
-            bmu2ros.pack_voltage = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.mod_status2 = frame.data[6];
-        } else if (frame.id == 0x103) {
-            if (frame.dlc <= 5) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.design_capacity = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.full_charge_capacity = (frame.data[2] << 8) | frame.data[3];
-            bmu2ros.remain_capacity = (frame.data[4] << 8) | frame.data[5];
-        } else if (frame.id == 0x110) {
-            if (frame.dlc <= 6) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.max_voltage.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.max_voltage.id = frame.data[2];
-            bmu2ros.min_voltage.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.min_voltage.id = frame.data[6];
-        } else if (frame.id == 0x111) {
-            if (frame.dlc <= 6) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.max_temp.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.max_temp.id = frame.data[2];
-            bmu2ros.min_temp.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.min_temp.id = frame.data[6];
-        } else if (frame.id == 0x112) {
-            if (frame.dlc <= 6) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.max_current.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.max_current.id = frame.data[2];
-            bmu2ros.min_current.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.min_current.id = frame.data[6];
-        } else if (frame.id == 0x113) {
-            if (frame.dlc <= 5) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.bmu_fw_ver = frame.data[0];
-            bmu2ros.mod_fw_ver = frame.data[1];
-            bmu2ros.serial_config = frame.data[2];
-            bmu2ros.parallel_config = frame.data[3];
-            bmu2ros.bmu_alarm1 = frame.data[4];
-            bmu2ros.bmu_alarm2 = frame.data[5];
-        } else if (frame.id == 0x120) {
-            if (frame.dlc <= 6) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.min_cell_voltage.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.min_cell_voltage.id = frame.data[2];
-            bmu2ros.max_cell_voltage.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.max_cell_voltage.id = frame.data[6];
-        } else if (frame.id == 0x130) {
-            if (frame.dlc <= 5) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                is_corrupted = true;
-                return false;
-            }
-
-            bmu2ros.manufacturing = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.inspection = (frame.data[2] << 8) | frame.data[3];
-            bmu2ros.serial = (frame.data[4] << 8) | frame.data[5];
-            result = true;
+    bool handler_bmu(zcan_frame &frame) {
+        uint32_t cycle{k_cycle_get_32()};
+        auto result{frames::bmu.decode(frame, bmu2ros)};
+        count_decode(cycle);
+        if (result == can_decoder::result::WRONG_DLC) {
+            LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
+            return false;
         }
-
-        return result;
+        if (result == can_decoder::result::DECODED) {
+            uint16_t bit(1 << frames::bmu.group(frame.id));
+            bmu2ros.received_ms[frames::bmu.group(frame.id)] = k_uptime_get_32();
+            // Every received group is published, even with unchanged values,
+            // so readers see the BMU alive and can keep their own keepalive.
+            bmu_updated = true;
+            bmu2ros.stale &= ~bit;
+            bmu_stale_reported &= ~bit;
+        }
+        return true;
     }
     bool handler_board(zcan_frame &frame) {
-        if (frame.id == 0x200) {
-            if (frame.dlc != 8) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                return false;
-            }
+        uint32_t cycle{k_cycle_get_32()};
+        uint8_t prev_state{board2ros.state};
+        bool prev_wait_shutdown{board2ros.wait_shutdown};
+        auto result{frames::board.decode(frame, board2ros)};
+        count_decode(cycle);
+        if (result == can_decoder::result::WRONG_DLC) {
+            LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
+            return false;
+        }
 
-            uint8_t prev_state{board2ros.state};
-            bool prev_wait_shutdown{board2ros.wait_shutdown};
-            board2ros.bumper_switch[0] = (frame.data[0] & 0b00001000) != 0;
-            board2ros.bumper_switch[1] = (frame.data[0] & 0b00010000) != 0;
-            board2ros.emergency_switch[0] = (frame.data[0] & 0b00000010) != 0;
-            board2ros.emergency_switch[1] = (frame.data[0] & 0b00000100) != 0;
-            board2ros.power_switch = (frame.data[0] & 0b00000001) != 0;
-            board2ros.wait_shutdown = (frame.data[1] & 0b10000000) != 0;
-            board2ros.auto_charging = (frame.data[1] & 0b00000010) != 0;
-            board2ros.shutdown_reason = (frame.data[1] & 0b01111100) >> 2;
-            board2ros.manual_charging = (frame.data[1] & 0b00000001) != 0;
-            board2ros.c_fet = (frame.data[2] & 0b00010000) != 0;
-            board2ros.d_fet = (frame.data[2] & 0b00100000) != 0;
-            board2ros.p_dsg = (frame.data[2] & 0b01000000) != 0;
-            board2ros.v5_fail = (frame.data[2] & 0b00000001) != 0;
-            board2ros.v16_fail = (frame.data[2] & 0b00000010) != 0;
-            board2ros.wheel_disable[0] = (frame.data[3] & 0b00000001) != 0;
-            board2ros.wheel_disable[1] = (frame.data[3] & 0b00000010) != 0;
-            board2ros.state = (frame.data[3] & 0b11111100) >> 2;
-            board2ros.fan_duty = frame.data[4];
-            board2ros.charge_connector_temp[0] = frame.data[5];
-            board2ros.charge_connector_temp[1] = frame.data[6];
-            board2ros.power_board_temp = frame.data[7];
+        if (frame.id == 0x200) {
             board2ros.main_board_temp = misc_controller::get_main_board_temp();
             for (auto i{0}; i < 3; ++i)
                 board2ros.actuator_board_temp[i] = misc_controller::get_actuator_board_temp(i);
+            put_switch();
             static constexpr uint8_t LOCKDOWN_STATE{7};
             if (prev_state != LOCKDOWN_STATE && board2ros.state == LOCKDOWN_STATE) {
                 led_controller::msg message{led_controller::msg::LOCKDOWN, 1000000000};
@@ -410,11 +516,6 @@ private:
                     k_msgq_purge(&led_controller::msgq);
             }
         } else if (frame.id == 0x202) {
-            if (frame.dlc == 0) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                return false;
-            }
-
             if (frame.data[0] == 1) {
                 led_controller::msg message{led_controller::msg::CHARGE_LEVEL, 2000};
                 while (k_msgq_put(&led_controller::msgq, &message, K_NO_WAIT) != 0)
@@ -429,21 +530,25 @@ private:
                 version_powerboard[n++] = '.';
             }
             version_powerboard[frame.dlc] = '\0';
-        } else if (frame.id == 0x204) {
-            if (frame.dlc <= 4) {
-                LOG_ERR("receive wrong dlc. frame.id:%x, frame.dlc: %d", frame.id, frame.dlc);
-                return false;
-            }
-
-            uint16_t voltage_mv{static_cast<uint16_t>(frame.data[0] | (frame.data[1] << 8))};
-            board2ros.charge_connector_voltage = voltage_mv * 1e-3f;
-            board2ros.charge_check_count = frame.data[2];
-            board2ros.charge_heartbeat_delay = frame.data[3];
-            board2ros.charge_temperature_error = frame.data[4];
         }
 
         return true;
     }
+    // Unlike the purged queues, a full switch queue keeps the queued edges
+    // and drops the newest sample, which chan_board still carries.
+    void put_switch() {
+        msg_switch message{
+            {board2ros.bumper_switch[0], board2ros.bumper_switch[1]},
+            {board2ros.emergency_switch[0], board2ros.emergency_switch[1]}
+        };
+        if (memcmp(&message, &switch2ros, sizeof message) == 0)
+            return;
+        if (k_msgq_put(&msgq_switch, &message, K_NO_WAIT) != 0) {
+            LOG_WRN("switch queue full");
+            return;
+        }
+        switch2ros = message;
+    }
     void handler_log(zcan_frame &frame) {
         for (uint32_t i{0}; i < frame.dlc; ++i) {
             uint8_t data{frame.data[i]};
@@ -452,17 +557,101 @@ private:
             log.putc(data);
         }
     }
+    // A group goes stale when it is older than the timeout, or when it never
+    // arrived within the timeout after boot. Each outage is reported once.
+    void check_bmu_stale() {
+        if (bmu_stale_timeout_ms == 0)
+            return;
+        uint32_t now{k_uptime_get_32()};
+        for (uint32_t i{0}; i < msg_bmu::FRAMES; ++i) {
+            uint16_t bit(1 << i);
+            if (now - bmu2ros.received_ms[i] <= bmu_stale_timeout_ms)
+                continue;
+            if ((bmu2ros.stale & bit) == 0) {
+                bmu2ros.stale |= bit;
+                bmu_updated = true;
+            }
+            if ((bmu_stale_reported & bit) == 0) {
+                bmu_stale_reported |= bit;
+                LOG_WRN("BMU frame 0x%03x is stale", frames::bmu.group_id(i));
+                msg_diagnostics message{
+                    .error{msg_diagnostics::STALE},
+                    .cob_id{frames::bmu.group_id(i)}
+                };
+                put_diagnostics(message);
+            }
+        }
+    }
+    // Bus state changes are reported as they come, overflows of a receive
+    // queue at most once a second.
+    void check_link() {
+        can_state state;
+        can_bus_err_cnt err_cnt;
+        if (stats.take_state_change(state, err_cnt)) {
+            LOG_WRN("CAN state %d tx errors %u rx errors %u", state, err_cnt.tx_err_cnt, err_cnt.rx_err_cnt);
+            msg_diagnostics message{
+                .error{msg_diagnostics::BUS_STATE},
+                .state{static_cast<uint8_t>(state)},
+                .tx_err_cnt{err_cnt.tx_err_cnt},
+                .rx_err_cnt{err_cnt.rx_err_cnt}
+            };
+            put_diagnostics(message);
+        }
+        uint32_t now{k_uptime_get_32()};
+        for (uint32_t i{0}; i < ARRAY_SIZE(rx_queues); ++i) {
+            uint32_t dropped{rx_queues[i].dropped};
+            if (dropped == overflow_reported[i] || now - overflow_reported_ms[i] < 1000)
+                continue;
+            LOG_WRN("CAN %s queue dropped %u frames", rx_queues[i].name, dropped - overflow_reported[i]);
+            msg_diagnostics message{
+                .error{msg_diagnostics::OVERFLOW},
+                .cob_id{rx_queues[i].id},
+                .dropped{dropped}
+            };
+            put_diagnostics(message);
+            overflow_reported[i] = dropped;
+            overflow_reported_ms[i] = now;
+        }
+    }
+    // A full queue keeps the reports that are already in it, the new one is
+    // counted instead.
+    void put_diagnostics(const msg_diagnostics &message) {
+        if (k_msgq_put(&msgq_diagnostics, &message, K_NO_WAIT) != 0)
+            ++diagnostics_dropped;
+    }
     void handler_corrupted_frame(zcan_frame &frame) {
+        diag2ros.error = msg_diagnostics::CORRUPTED;
         diag2ros.cob_id = frame.id;
         diag2ros.dlc = frame.dlc;
-        while (k_msgq_put(&msgq_diagnostics, &diag2ros, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq_diagnostics);
+        put_diagnostics(diag2ros);
 
         led_controller::msg message{led_controller::msg::CHARGING, 1000};
         while (k_msgq_put(&led_controller::msgq, &message, K_NO_WAIT) != 0)
             k_msgq_purge(&led_controller::msgq);
     }
-    void send_message() const {
+    void count_decode(uint32_t cycle) {
+        uint32_t dt{k_cycle_get_32() - cycle};
+        decode_cycles += dt;
+        if (decode_cycles_max < dt)
+            decode_cycles_max = dt;
+        ++decode_frames;
+    }
+    bool get_emergency_switch() const {
+        return board2ros.emergency_switch[0] ||
+               board2ros.emergency_switch[1];
+    }
+    // Written on every wakeup, at least once per heartbeat period, as the
+    // shell commands change ros2board too.
+    void update_state() {
+        msg_state state{
+            .emergency_switch{get_emergency_switch()},
+            .bumper_switch{board2ros.bumper_switch[0] || board2ros.bumper_switch[1]},
+            .emergency_stop{ros2board.emergency_stop},
+            .rsoc{bmu2ros.rsoc}
+        };
+        snapshot.write(state);
+    }
+    void build_message(zcan_frame &frame) const {
         bool main_overheat{board2ros.main_board_temp > 75.0f};
         bool actuator_overheat{false};
         for (const auto &i: board2ros.actuator_board_temp) {
@@ -470,7 +659,7 @@ private:
                 actuator_overheat = true;
         }
         const bool should_lockdown = !get_emergency_switch() && (ros2board.lockdown || heartbeat_timeout);
-        zcan_frame frame{
+        frame = zcan_frame{
             .id{0x201},
             .rtr{CAN_DATAFRAME},
             .id_type{CAN_STANDARD_IDENTIFIER},
@@ -485,15 +674,42 @@ private:
                 ros2board.auto_charge_request_enable,
             }
         };
-        can_send(dev, &frame, K_MSEC(100), nullptr, nullptr);
     }
+    // can_send() blocks until the frame is transmitted, so the request
+    // latency covers the whole path from the ROS callback to the bus.
+    // The payload only counts as sent once can_send() succeeds, so a failed
+    // change is still seen as one on the next attempt.
+    bool send_message(const zcan_frame &frame, bool changed) {
+        prev_cycle_send = k_cycle_get_32();
+        int result{can_send(dev, &frame, K_MSEC(100), nullptr, nullptr)};
+        stats.sent(result);
+        if (result != 0)
+            return false;
+        memcpy(sent_data, frame.data, sizeof sent_data);
+        if (changed && request_pending)
+            stats.request_sent(request_cycle);
+        request_pending = false;
+        return true;
+    }
+    static constexpr uint32_t SEND_PERIOD_MS{100}, MIN_GAP_MS{5}, BMU_STALE_TIMEOUT_MS{3000};
     msg_bmu bmu2ros{0};
     msg_board board2ros{0};
+    msg_switch switch2ros{};
     msg_control ros2board{true, false};
     msg_diagnostics diag2ros{};
+    seqlock<msg_state> snapshot;
     log_printer log;
-    uint32_t prev_cycle_ros{0}, prev_cycle_send{0};
+    uint64_t decode_cycles{0};
+    uint32_t prev_cycle_ros{0}, prev_cycle_send{0}, request_cycle{0}, decode_cycles_max{0}, decode_frames{0};
+    uint32_t bmu_stale_timeout_ms{BMU_STALE_TIMEOUT_MS};
+    uint32_t overflow_reported[ARRAY_SIZE(rx_queues)]{}, overflow_reported_ms[ARRAY_SIZE(rx_queues)]{};
+    uint32_t diagnostics_dropped{0};
+    uint16_t bmu_stale_reported{0};
+    uint8_t sent_data[8]{};
+    bool bmu_updated{false}, request_pending{false};
     const device *dev{nullptr};
+    k_timer timer_send;
+    k_poll_signal signal_send;
     char version_powerboard[32]{""};
     bool heartbeat_timeout{true};
 
@@ -508,8 +724,15 @@ int bmu_info(const shell *shell, size_t argc, char **argv)
     return 0;
 }
 
+int bmu_timeout(const shell *shell, size_t argc, char **argv)
+{
+    impl.bmu_timeout(shell, argc > 1 ? atoi(argv[1]) : -1);
+    return 0;
+}
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_bmu,
     SHELL_CMD(info, NULL, "BMU information", bmu_info),
+    SHELL_CMD(timeout, NULL, "BMU stale timeout [ms], 0 disables", bmu_timeout),
     SHELL_SUBCMD_SET_END
 );
 SHELL_CMD_REGISTER(bmu, &sub_bmu, "BMU commands", NULL);
@@ -547,6 +770,25 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_brd,
 );
 SHELL_CMD_REGISTER(brd, &sub_brd, "Board commands", NULL);
 
+int can_stats(const shell *shell, size_t argc, char **argv)
+{
+    impl.can_stats(shell);
+    return 0;
+}
+
+int can_reset(const shell *shell, size_t argc, char **argv)
+{
+    impl.can_reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_can,
+    SHELL_CMD(stats, NULL, "CAN receive, transmit and bus statistics", can_stats),
+    SHELL_CMD(reset, NULL, "Reset CAN statistics", can_reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(can, &sub_can, "CAN commands", NULL);
+
 void init()
 {
     impl.init();
@@ -557,28 +799,51 @@ void run(void *p1, void *p2, void *p3)
     impl.run();
 }
 
+void get_state(msg_state &state)
+{
+    impl.get_state(state);
+}
+
+bool get_safety_stop(uint32_t &cycle)
+{
+    auto state{static_cast<uint32_t>(atomic_get(&safety_state))};
+    cycle = state & ~1U;
+    return (state & 1) != 0;
+}
+
 uint32_t get_rsoc()
 {
-    return impl.get_rsoc();
+    msg_state state;
+    impl.get_state(state);
+    return state.rsoc;
 }
 
 bool get_emergency_switch()
 {
-    return impl.get_emergency_switch();
+    msg_state state;
+    impl.get_state(state);
+    return state.emergency_switch;
 }
 
 bool get_bumper_switch()
 {
-    return impl.get_bumper_switch();
+    msg_state state;
+    impl.get_state(state);
+    return state.bumper_switch;
 }
 
 bool is_emergency()
 {
-    return impl.is_emergency();
+    msg_state state;
+    impl.get_state(state);
+    return state.is_emergency();
 }
 
 k_thread thread;
-k_msgq msgq_bmu, msgq_board, msgq_control, msgq_diagnostics;
+channel<msg_bmu> chan_bmu{"bmu"};
+channel<msg_board> chan_board{"board"};
+k_msgq msgq_control, msgq_diagnostics, msgq_switch;
+k_sem sem_safety;
 
 }
 
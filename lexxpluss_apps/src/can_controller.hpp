@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include "channel.hpp"
 
 namespace lexxhard::can_controller {
 
@@ -43,6 +44,24 @@ struct msg_bmu {
     uint16_t manufacturing, inspection, serial;
     uint8_t mod_status1, mod_status2, bmu_status, asoc, rsoc, soh;
     uint8_t bmu_fw_ver, mod_fw_ver, serial_config, parallel_config, bmu_alarm1, bmu_alarm2;
+    // Freshness of each frame group, numbered 0x100, 0x101, 0x103, 0x110,
+    // 0x111, 0x112, 0x113, 0x120 and 0x130. received_ms is the uptime of the
+    // last frame and stale marks the groups not received within the timeout.
+    static constexpr uint32_t FRAMES{9};
+    uint32_t received_ms[FRAMES];
+    uint16_t stale;
+    // The groups received since the observer's previous call, seen_ms keeps
+    // the receive times it has seen.
+    uint16_t received_since(uint32_t (&seen_ms)[FRAMES]) const {
+        uint16_t mask{0};
+        for (uint32_t i{0}; i < FRAMES; ++i) {
+            if (received_ms[i] != seen_ms[i]) {
+                seen_ms[i] = received_ms[i];
+                mask |= 1 << i;
+            }
+        }
+        return mask;
+    }
 } __attribute__((aligned(4)));
 
 struct msg_board {
@@ -57,24 +76,54 @@ struct msg_board {
     bool charge_temperature_error;
 } __attribute__((aligned(4)));
 
+// Bumper and emergency switches, queued on every change so that a short
+// press is not lost between two reads of chan_board.
+struct msg_switch {
+    bool bumper_switch[2];
+    bool emergency_switch[2];
+} __attribute__((aligned(4)));
+
 struct msg_control {
     bool emergency_stop, power_off, wheel_power_off, lockdown, auto_charge_request_enable;
+    uint32_t cycle; // k_cycle_get_32() of the ROS request
+} __attribute__((aligned(4)));
+
+// Board state for the other threads. The CAN thread publishes it as a whole,
+// so a reader never sees a frame that is only half decoded.
+struct msg_state {
+    bool emergency_switch, bumper_switch, emergency_stop;
+    uint8_t rsoc;
+    bool is_emergency() const {
+        return emergency_switch || bumper_switch || emergency_stop;
+    }
 } __attribute__((aligned(4)));
 
-// msg_diagnostics only support can msg length failure for now
+// A frame with a wrong dlc, a BMU frame group that stopped arriving, a bus
+// state change or frames dropped by a full receive queue.
 struct msg_diagnostics {
-    uint16_t cob_id;
+    enum : uint8_t {CORRUPTED, STALE, BUS_STATE, OVERFLOW} error;
+    uint16_t cob_id; // filter id for OVERFLOW
     uint8_t dlc;
+    uint8_t state, tx_err_cnt, rx_err_cnt; // BUS_STATE, state is a can_state
+    uint32_t dropped; // OVERFLOW, total since boot
 } __attribute__((aligned(4)));
 
 void init();
 void run(void *p1, void *p2, void *p3);
+void get_state(msg_state &state);
+// True while the last 0x200 frame has an emergency or bumper switch on. It is
+// decoded in the CAN receive interrupt, cycle tells when it last changed (bit 0
+// is always clear) and sem_safety is given on every change.
+bool get_safety_stop(uint32_t &cycle);
 uint32_t get_rsoc();
 bool get_emergency_switch();
 bool get_bumper_switch();
 bool is_emergency();
 extern k_thread thread;
-extern k_msgq msgq_bmu, msgq_board, msgq_control, msgq_diagnostics;
+extern channel<msg_bmu> chan_bmu;
+extern channel<msg_board> chan_board;
+extern k_msgq msgq_control, msgq_diagnostics, msgq_switch;
+extern k_sem sem_safety;
 
 }
 
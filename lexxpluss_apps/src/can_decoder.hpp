@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <drivers/can.h>
+#include <cstddef>
+#include <cstring>
+
+namespace lexxhard::can_decoder {
+
+enum class type : uint8_t {NONE, U8, U16, I16, BOOL, FLOAT};
+enum class result {UNKNOWN, WRONG_DLC, DECODED};
+
+// One payload field of a frame. Rows of the same id are adjacent and repeat
+// the minimum dlc of their frame, a NONE row only declares a frame.
+struct field {
+    uint16_t id;
+    uint8_t dlc, byte, width;
+    bool big_endian;
+    uint8_t mask, shift;
+    type dst;
+    uint16_t offset;
+    float scale;
+};
+
+constexpr uint8_t mask_shift(uint8_t mask)
+{
+    uint8_t shift{0};
+    while (mask != 0 && (mask & 1) == 0) {
+        mask >>= 1;
+        ++shift;
+    }
+    return shift;
+}
+
+constexpr field frame(uint16_t id, uint8_t dlc)
+{
+    return {id, dlc, 0, 0, false, 0, 0, type::NONE, 0, 1.0f};
+}
+
+constexpr field u8(uint16_t id, uint8_t dlc, uint8_t byte, type dst, uint16_t offset)
+{
+    return {id, dlc, byte, 1, false, 0, 0, dst, offset, 1.0f};
+}
+
+constexpr field bits(uint16_t id, uint8_t dlc, uint8_t byte, uint8_t mask, type dst, uint16_t offset)
+{
+    return {id, dlc, byte, 1, false, mask, mask_shift(mask), dst, offset, 1.0f};
+}
+
+constexpr field be16(uint16_t id, uint8_t dlc, uint8_t byte, type dst, uint16_t offset)
+{
+    return {id, dlc, byte, 2, true, 0, 0, dst, offset, 1.0f};
+}
+
+constexpr field le16(uint16_t id, uint8_t dlc, uint8_t byte, type dst, uint16_t offset, float scale = 1.0f)
+{
+    return {id, dlc, byte, 2, false, 0, 0, dst, offset, scale};
+}
+
+constexpr size_t size_of(type dst)
+{
+    switch (dst) {
+    case type::U8:    return sizeof (uint8_t);
+    case type::U16:   return sizeof (uint16_t);
+    case type::I16:   return sizeof (int16_t);
+    case type::BOOL:  return sizeof (bool);
+    case type::FLOAT: return sizeof (float);
+    default:          return 0;
+    }
+}
+
+// Decoder generated from a field table for the ids BASE to BASE + SPAN - 1,
+// which is the range of the acceptance filter. The id indexes the table
+// directly, and valid() lets the owner check the table with static_assert.
+template<typename T, uint16_t BASE, uint16_t SPAN, size_t N>
+class decoder {
+public:
+    constexpr decoder(const field (&fields)[N]) {
+        for (size_t i{0}; i < N; ++i) {
+            table[i] = fields[i];
+            if (fields[i].id < BASE || fields[i].id - BASE >= SPAN)
+                continue;
+            auto &e{index[fields[i].id - BASE]};
+            if (e.count++ == 0) {
+                e.first = i;
+                e.group = group_num;
+                group_ids[group_num++] = fields[i].id;
+            }
+        }
+    }
+    constexpr bool valid() const {
+        if (N > 0xff)
+            return false;
+        for (size_t i{0}; i < N; ++i) {
+            const auto &f{table[i]};
+            if (f.id < BASE || f.id - BASE >= SPAN || f.dlc > 8)
+                return false;
+            const auto &e{index[f.id - BASE]};
+            if (i < e.first || i >= e.first + e.count || f.dlc != table[e.first].dlc)
+                return false;
+            if (f.byte + f.width > f.dlc || (f.mask != 0 && f.width != 1))
+                return false;
+            if ((f.dst == type::NONE) != (f.width == 0) || f.offset + size_of(f.dst) > sizeof (T))
+                return false;
+        }
+        return true;
+    }
+    result decode(const zcan_frame &frame, T &dst) const {
+        uint32_t n{static_cast<uint32_t>(frame.id) - BASE};
+        if (n >= SPAN || index[n].count == 0)
+            return result::UNKNOWN;
+        const auto &e{index[n]};
+        if (frame.dlc < table[e.first].dlc)
+            return result::WRONG_DLC;
+        for (uint32_t i{e.first}; i < e.first + e.count; ++i)
+            store(table[i], frame.data, reinterpret_cast<uint8_t*>(&dst));
+        return result::DECODED;
+    }
+    // Frames are numbered in table order, so the owner can keep per frame
+    // state in plain arrays of groups() entries.
+    constexpr uint32_t groups() const {
+        return group_num;
+    }
+    int group(uint32_t id) const {
+        uint32_t n{id - BASE};
+        return n < SPAN && index[n].count != 0 ? index[n].group : -1;
+    }
+    uint16_t group_id(uint32_t group) const {
+        return group < group_num ? group_ids[group] : 0;
+    }
+private:
+    static void store(const field &f, const uint8_t *data, uint8_t *dst) {
+        uint32_t raw{data[f.byte]};
+        if (f.width == 2)
+            raw = f.big_endian ? raw << 8 | data[f.byte + 1] : raw | data[f.byte + 1] << 8;
+        if (f.mask != 0)
+            raw = (raw & f.mask) >> f.shift;
+        switch (f.dst) {
+        case type::U8:    write(dst + f.offset, static_cast<uint8_t>(raw));          break;
+        case type::U16:   write(dst + f.offset, static_cast<uint16_t>(raw));         break;
+        case type::I16:   write(dst + f.offset, static_cast<int16_t>(raw));          break;
+        case type::BOOL:  write(dst + f.offset, raw != 0);                           break;
+        case type::FLOAT: write(dst + f.offset, static_cast<float>(raw) * f.scale);  break;
+        default:          break;
+        }
+    }
+    template<typename V>
+    static void write(uint8_t *dst, V value) {
+        memcpy(dst, &value, sizeof value);
+    }
+    struct entry {
+        uint8_t first, count, group;
+    };
+    field table[N]{};
+    entry index[SPAN]{};
+    uint16_t group_ids[N]{};
+    uint32_t group_num{0};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <drivers/can.h>
+#include <sys/atomic.h>
+#include <cstring>
+
+namespace lexxhard {
+
+// CAN link counters. received() and state_changed() run in interrupt
+// context, sent() in the controller thread, and the shell only reads.
+class can_monitor {
+public:
+    static constexpr uint32_t IDS{24}, BUCKETS{12};
+    struct latency {
+        uint32_t samples, sum_us, max_us;
+    };
+    struct id_stat {
+        uint32_t id, frames, prev_cycle, min_gap_us, max_gap_us;
+        uint32_t histogram[BUCKETS]; // inter-arrival time, bucket n holds [2^(n-1), 2^n) ms
+    };
+    void received(uint32_t id, uint32_t cycle) {
+        id_stat *stat{find(id)};
+        if (stat == nullptr) {
+            ++untracked;
+            return;
+        }
+        if (stat->frames > 0) {
+            uint32_t gap{cycle - stat->prev_cycle};
+            uint32_t us{k_cyc_to_us_floor32(gap)}, ms{k_cyc_to_ms_floor32(gap)};
+            if (stat->frames == 1 || stat->min_gap_us > us)
+                stat->min_gap_us = us;
+            if (stat->max_gap_us < us)
+                stat->max_gap_us = us;
+            uint32_t bucket{ms == 0 ? 0 : 32 - static_cast<uint32_t>(__builtin_clz(ms))};
+            ++stat->histogram[bucket < BUCKETS ? bucket : BUCKETS - 1];
+        }
+        stat->prev_cycle = cycle;
+        ++stat->frames;
+    }
+    void sent(int result) {
+        if (result == 0) {
+            ++tx_ok;
+        } else {
+            ++tx_fail;
+            tx_last_error = result;
+        }
+    }
+    // Time from a ROS request to the transmission of the frame carrying it.
+    void request_sent(uint32_t cycle) {
+        uint32_t us{k_cyc_to_us_floor32(k_cycle_get_32() - cycle)};
+        request.sum_us += us;
+        if (request.max_us < us)
+            request.max_us = us;
+        ++request.samples;
+    }
+    void state_changed(can_state state, can_bus_err_cnt err_cnt) {
+        if (state == CAN_BUS_OFF)
+            ++bus_off;
+        else if (state == CAN_ERROR_PASSIVE)
+            ++error_passive;
+        if (this->state == CAN_BUS_OFF && state != CAN_BUS_OFF)
+            ++recovered;
+        this->state = state;
+        this->err_cnt = err_cnt;
+        atomic_set(&state_pending, 1);
+    }
+    // Returns the latest state once after each change.
+    bool take_state_change(can_state &state, can_bus_err_cnt &err_cnt) {
+        if (atomic_clear(&state_pending) == 0)
+            return false;
+        unsigned int key{irq_lock()};
+        state = this->state;
+        err_cnt = this->err_cnt;
+        irq_unlock(key);
+        return true;
+    }
+    void reset() {
+        unsigned int key{irq_lock()};
+        memset(slots, 0, sizeof slots);
+        ids_num = untracked = tx_ok = tx_fail = 0;
+        bus_off = error_passive = recovered = 0;
+        tx_last_error = 0;
+        request = {0, 0, 0};
+        reset_ms = k_uptime_get_32();
+        irq_unlock(key);
+    }
+    template<typename F>
+    void for_each(F func) const {
+        for (uint32_t i{0}; i < ids_num; ++i)
+            func(ids[i]);
+    }
+    uint32_t get_elapsed_ms() const {return k_uptime_get_32() - reset_ms;}
+    uint32_t get_untracked() const {return untracked;}
+    uint32_t get_tx_ok() const {return tx_ok;}
+    uint32_t get_tx_fail() const {return tx_fail;}
+    int get_tx_last_error() const {return tx_last_error;}
+    latency get_request_latency() const {return request;}
+    uint32_t get_bus_off() const {return bus_off;}
+    uint32_t get_error_passive() const {return error_passive;}
+    uint32_t get_recovered() const {return recovered;}
+private:
+    // The ids passed by the receive filters of can_controller each have a
+    // slot, which holds the index of their entry in ids plus one, so that a
+    // frame finds its entry without a search.
+    struct range {
+        uint16_t base, span;
+    };
+    static constexpr range RANGES[]{{0x100, 64}, {0x200, 8}, {0x300, 1}};
+    static constexpr uint32_t SLOTS{64 + 8 + 1};
+    id_stat *find(uint32_t id) {
+        uint32_t slot{0};
+        for (const auto &i : RANGES) {
+            if (id - i.base < i.span) {
+                slot += id - i.base;
+                break;
+            }
+            slot += i.span;
+        }
+        if (slot >= SLOTS)
+            return nullptr;
+        if (slots[slot] != 0)
+            return &ids[slots[slot] - 1];
+        if (ids_num >= IDS)
+            return nullptr;
+        ids[ids_num] = id_stat{};
+        ids[ids_num].id = id;
+        slots[slot] = ++ids_num;
+        return &ids[ids_num - 1];
+    }
+    id_stat ids[IDS];
+    uint8_t slots[SLOTS]{};
+    uint32_t ids_num{0}, untracked{0}, tx_ok{0}, tx_fail{0};
+    uint32_t bus_off{0}, error_passive{0}, recovered{0}, reset_ms{0};
+    int tx_last_error{0};
+    latency request{0, 0, 0};
+    can_state state{CAN_ERROR_ACTIVE};
+    can_bus_err_cnt err_cnt{0, 0};
+    atomic_t state_pending{ATOMIC_INIT(0)};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -23,15 +23,30 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#pragma once
-
 #include <zephyr.h>
+#include <shell/shell.h>
+#include "channel.hpp"
+
+namespace lexxhard {
+
+namespace {
 
-namespace lexxhard::rosserial_service {
+int cmd_list(const shell *shell, size_t argc, char **argv)
+{
+    channel_base::for_each([&](channel_base &ch) {
+        shell_print(shell, "%s publishes:%u observers:%u",
+                    ch.get_name(), ch.get_publishes(), ch.get_observers());
+    });
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(list, NULL, "Channels with their publishes and observers", cmd_list),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(bus, &sub, "Controller data bus commands", NULL);
 
-void init();
-void run(void *p1, void *p2, void *p3);
-extern k_thread thread;
+}
 
 }
 
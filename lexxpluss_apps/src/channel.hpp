@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "seqlock.hpp"
+#include "writer_gate.hpp"
+
+namespace lexxhard {
+
+// Every channel is listed for the bus shell command.
+class channel_base {
+public:
+    explicit channel_base(const char *name) : name{name} {
+        if (tail == nullptr)
+            head = this;
+        else
+            tail->next = this;
+        tail = this;
+    }
+    const char *get_name() const {return name;}
+    uint32_t get_observers() const {return observers;}
+    virtual uint32_t get_publishes() const = 0;
+    template<typename F>
+    static void for_each(F func) {
+        for (auto i{head}; i != nullptr; i = i->next)
+            func(*i);
+    }
+protected:
+    uint32_t observers{0};
+private:
+    const char *name;
+    channel_base *next{nullptr};
+    static inline channel_base *head{nullptr}, *tail{nullptr};
+};
+
+// A typed sample published by one controller and observed by any number of
+// threads. The sample is stored once, each observer copies it out at its own
+// pace and counts the samples it missed. Observers subscribe from init()
+// before the threads start, either woken by their own poll signal on every
+// publish or polled.
+template<typename T>
+class channel : public channel_base {
+public:
+    class observer {
+    public:
+        bool get(T &value) {
+            if (wake)
+                k_poll_signal_reset(&signal);
+            if (ch == nullptr || ch->lock.get_seq() == seq)
+                return false;
+            uint32_t s{ch->lock.read(value)};
+            missed += s - seq - 1;
+            seq = s;
+            return true;
+        }
+        uint32_t get_missed() const {return missed;}
+        k_poll_signal *get_signal() {return &signal;}
+    private:
+        channel *ch{nullptr};
+        observer *next{nullptr};
+        uint32_t seq{0}, missed{0};
+        bool wake{false};
+        k_poll_signal signal;
+        friend class channel;
+    };
+    explicit channel(const char *name) : channel_base{name} {}
+    void subscribe(observer &o, bool wake = true) {
+        o.ch = this;
+        o.seq = lock.get_seq();
+        o.wake = wake;
+        k_poll_signal_init(&o.signal);
+        o.next = first;
+        first = &o;
+        ++observers;
+    }
+    // A sample published while a test source holds the channel is discarded.
+    void publish(const T &value) {
+        if (!gate.enter())
+            return;
+        inject(value);
+        gate.leave();
+    }
+    // The test source publishes with inject() between capture() and release().
+    void inject(const T &value) {
+        lock.write(value);
+        for (auto i{first}; i != nullptr; i = i->next) {
+            if (i->wake)
+                k_poll_signal_raise(&i->signal, 0);
+        }
+    }
+    // The latest sample, for readers that do not track what they have seen.
+    void read(T &value) const {
+        lock.read(value);
+    }
+    uint32_t get_publishes() const override {
+        return lock.get_seq();
+    }
+    void capture() {gate.capture();}
+    void release() {gate.release();}
+private:
+    seqlock<T> lock;
+    writer_gate gate;
+    observer *first{nullptr};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -34,12 +34,10 @@ namespace lexxhard::imu_controller {
 
 LOG_MODULE_REGISTER(imu);
 
-char __aligned(4) msgq_buffer[8 * sizeof (msg)];
-
 class {
 public:
     int init() {
-        k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
+        ring.init();
         dev = device_get_binding("ADIS16470");
         if (!device_is_ready(dev))
             return -1;
@@ -50,6 +48,7 @@ public:
             message.delta_vel[i] = 0;
         }
         message.temp = 0;
+        message.cycle = 0;
         LOG_INF("IMU controller for LexxPluss board. (%p)", dev);
         return 0;
     }
@@ -58,6 +57,7 @@ public:
             return;
         while (true) {
             if (sensor_sample_fetch_chan(dev, SENSOR_CHAN_ALL) == 0) {
+                message.cycle = k_cycle_get_32();
                 message.accel[0] = get_sensor_value_as_float(SENSOR_CHAN_ACCEL_X);
                 message.accel[1] = get_sensor_value_as_float(SENSOR_CHAN_ACCEL_Y);
                 message.accel[2] = get_sensor_value_as_float(SENSOR_CHAN_ACCEL_Z);
@@ -71,14 +71,12 @@ public:
                 message.delta_vel[0] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 3);
                 message.delta_vel[1] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 4);
                 message.delta_vel[2] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 5);
-                while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
-                    k_msgq_purge(&msgq);
+                ring.put(message);
                 runaway_detector::msg message_runaway{
                     .accel{message.accel[0], message.accel[1], message.accel[2]},
                     .gyro{message.gyro[0], message.gyro[1], message.gyro[2]}
                 };
-                while (k_msgq_put(&runaway_detector::msgq, &message_runaway, K_NO_WAIT) != 0)
-                    k_msgq_purge(&runaway_detector::msgq);
+                runaway_detector::ring.put(message_runaway);
             }
             k_msleep(1);
         }
@@ -134,7 +132,7 @@ void run(void *p1, void *p2, void *p3)
 }
 
 k_thread thread;
-k_msgq msgq;
+spsc_ring<msg, 32> ring;
 
 }
 
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include "spsc_ring.hpp"
 
 namespace lexxhard::imu_controller {
 
@@ -35,12 +36,13 @@ struct msg {
     float delta_ang[3];
     float delta_vel[3];
     float temp;
+    uint32_t cycle;
 } __attribute__((aligned(4)));
 
 void init();
 void run(void *p1, void *p2, void *p3);
 extern k_thread thread;
-extern k_msgq msgq;
+extern spsc_ring<msg, 32> ring;
 
 }
 
@@ -71,9 +71,11 @@ public:
 
             msg_amr_status message_amr_status;
             if (k_msgq_get(&msgq_amr_status, &message_amr_status, K_NO_WAIT) == 0) {
-                is_emergency_stop_at_amr = message_amr_status.is_emergency_stop   ||
-                                           can_controller::get_emergency_switch() ||
-					   can_controller::get_bumper_switch();
+                can_controller::msg_state state;
+                can_controller::get_state(state);
+                is_emergency_stop_at_amr = message_amr_status.is_emergency_stop ||
+                                           state.emergency_switch ||
+                                           state.bumper_switch;
             } else {
                 is_emergency_stop_at_amr = true;
             }
@@ -34,8 +34,7 @@
 #include "led_controller.hpp"
 #include "misc_controller.hpp"
 #include "pgv_controller.hpp"
-#include "rosserial.hpp"
-#include "rosserial_service.hpp"
+#include "rosserial_node.hpp"
 #include "runaway_detector.hpp"
 #include "tof_controller.hpp"
 #include "uss_controller.hpp"
@@ -52,8 +51,6 @@ K_THREAD_STACK_DEFINE(interlock_controller_stack, 2048);
 K_THREAD_STACK_DEFINE(led_controller_stack, 2048);
 K_THREAD_STACK_DEFINE(misc_controller_stack, 2048);
 K_THREAD_STACK_DEFINE(pgv_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(rosserial_stack, 2048);
-K_THREAD_STACK_DEFINE(rosserial_service_stack, 2048);
 K_THREAD_STACK_DEFINE(runaway_detector_stack, 2048);
 K_THREAD_STACK_DEFINE(tof_controller_stack, 2048);
 K_THREAD_STACK_DEFINE(uss_controller_stack, 2048);
@@ -107,8 +104,7 @@ void main()
     lexxhard::led_controller::init();
     lexxhard::misc_controller::init();
     lexxhard::pgv_controller::init();
-    lexxhard::rosserial::init();
-    lexxhard::rosserial_service::init();
+    lexxhard::rosserial_node::init();
     lexxhard::runaway_detector::init();
     lexxhard::tof_controller::init();
     lexxhard::uss_controller::init();
@@ -139,8 +135,7 @@ void main()
             break;
     }
 
-    RUN(rosserial, 5); // The rosserial thread will be started last.
-    RUN(rosserial_service, 6); // The rosserial thread will be started last.
+    lexxhard::rosserial_node::start(); // The rosserial threads will be started last.
     const device *gpiog{device_get_binding("GPIOG")};
     if (gpiog != nullptr)
         gpio_pin_configure(gpiog, 7, GPIO_OUTPUT_LOW | GPIO_ACTIVE_HIGH);
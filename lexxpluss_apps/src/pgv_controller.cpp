@@ -36,13 +36,11 @@ namespace lexxhard::pgv_controller {
 
 LOG_MODULE_REGISTER(pgv);
 
-char __aligned(4) msgq_buffer[8 * sizeof (msg)];
 char __aligned(4) msgq_control_buffer[8 * sizeof (msg_control)];
 
 class pgv_controller_impl {
 public:
     int init() {
-        k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
         k_msgq_init(&msgq_control, msgq_control_buffer, sizeof (msg_control), 8);
         ring_buf_init(&rxbuf.rb, sizeof rxbuf.buf, rxbuf.buf);
         ring_buf_init(&txbuf.rb, sizeof txbuf.buf, txbuf.buf);
@@ -99,8 +97,8 @@ public:
                 heartbeat_led = !heartbeat_led;
             }
             if (get_position(pgv2ros)) {
-                while (k_msgq_put(&msgq, &pgv2ros, K_NO_WAIT) != 0)
-                    k_msgq_purge(&msgq);
+                pgv2ros.cycle = k_cycle_get_32();
+                chan.publish(pgv2ros);
             }
             msg_control ros2pgv;
             if (k_msgq_get(&msgq_control, &ros2pgv, K_NO_WAIT) == 0) {
@@ -302,7 +300,8 @@ void run(void *p1, void *p2, void *p3)
 }
 
 k_thread thread;
-k_msgq msgq, msgq_control;
+channel<msg> chan{"pgv"};
+k_msgq msgq_control;
 
 }
 
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include "channel.hpp"
 
 namespace lexxhard::pgv_controller {
 
@@ -38,6 +39,7 @@ struct msg {
     struct {
         bool cc2, cc1, wrn, np, err, tag, rp, nl, ll, rl;
     } f;
+    uint32_t cycle;
 } __attribute__((aligned(4)));
 
 struct msg_control {
@@ -47,7 +49,8 @@ struct msg_control {
 void init();
 void run(void *p1, void *p2, void *p3);
 extern k_thread thread;
-extern k_msgq msgq, msgq_control;
+extern channel<msg> chan;
+extern k_msgq msgq_control;
 
 }
 
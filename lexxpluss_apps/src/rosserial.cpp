@@ -23,83 +23,468 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <devicetree.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include "rosserial_hardware_zephyr.hpp"
 #include "rosserial_actuator.hpp"
+#include "rosserial_baud.hpp"
+#include "rosserial_bench.hpp"
 #include "rosserial_bmu.hpp"
 #include "rosserial_board.hpp"
 #include "rosserial_dfu.hpp"
 #include "rosserial_imu.hpp"
 #include "rosserial_interlock.hpp"
 #include "rosserial_led.hpp"
+#include "rosserial_link.hpp"
 #include "rosserial_pgv.hpp"
+#include "rosserial_robot_state.hpp"
+#include "rosserial_template.hpp"
 #include "rosserial_tof.hpp"
 #include "rosserial_uss.hpp"
-#include "rosserial.hpp"
+#include "rosserial_node.hpp"
 #include "rosserial_towing_unit.hpp"
+#include "runaway_detector.hpp"
 
 namespace lexxhard::rosserial {
 
-class {
+LOG_MODULE_REGISTER(rosserial);
+
+class rosserial_impl : public rosserial_node::node {
 public:
-    int init() {
-        nh.getHardware()->set_baudrate(921600);
+    rosserial_impl() : node{"UART_6", rosserial_node::thread_priority::LINK, SPIN_PERIOD_MS} {}
+    int init() override {
+        nh.getHardware()->set_baudrate(DEFAULT_BAUDRATE);
         nh.initNode(const_cast<char*>("UART_6"));
         actuator.init(nh);
+        baud.init(nh, DEFAULT_BAUDRATE, FLOW_CONTROL);
         bmu.init(nh);
         board.init(nh);
         dfu.init(nh);
         imu.init(nh);
         interlock.init(nh);
         led.init(nh);
+        link_diagnostics.init(nh);
         pgv.init(nh);
+        robot_state.init(nh);
         tof.init(nh);
         uss.init(nh);
         towing_unit.init(nh);
-        return 0;
+        ros_publisher::apply_priority(nh);
+        nh.for_each_failed([](const char *topic) {
+            LOG_ERR("no slot for %s.", topic);
+        });
+        return nh.get_failed() == 0 ? 0 : -1;
+    }
+    void spin() override {
+        k_poll_signal_reset(nh.getHardware()->get_rx_signal());
+        if (uint32_t cycle{nh.getHardware()->take_rx_cycle()}; cycle != 0) {
+            uint32_t us{k_cyc_to_us_floor32(k_cycle_get_32() - cycle)};
+            rx_latency_sum_us += us;
+            if (rx_latency_max_us < us)
+                rx_latency_max_us = us;
+            ++rx_latency_count;
+        }
+        uint32_t spin_cycle{k_cycle_get_32()};
+        nh.spinOnce();
+        if (bool connected{nh.connected()}; connected != prev_connected) {
+            if (connected) {
+                ros_publisher::load_params(nh);
+                ros_stamp::load_params(nh);
+                imu.load_params(nh);
+                robot_state.load_params(nh);
+            }
+            prev_connected = connected;
+        }
+        baud.poll(nh);
+        actuator.poll(nh);
+        bmu.poll();
+        board.poll(nh);
+        dfu.poll();
+        imu.poll(nh);
+        interlock.poll();
+        led.poll();
+        pgv.poll(nh);
+        tof.poll(nh);
+        uss.poll(nh);
+        towing_unit.poll();
+        robot_state.poll(nh);
+        link_diagnostics.record_spin(k_cyc_to_us_floor32(k_cycle_get_32() - spin_cycle));
+        link_diagnostics.poll(nh);
+    }
+    void link(const shell *shell, uint32_t sec) {
+        auto hardware{nh.getHardware()};
+        auto begin{hardware->get_stats()};
+        hardware->reset_tx_latency();
+        k_sleep(K_SECONDS(sec));
+        auto end{hardware->get_stats()};
+        shell_print(shell,
+                    "mode:%s baud:%u isr:%u/s rx:%u bytes/s tx:%u bytes/s\n"
+                    "rx errors:%u tx errors:%u baud fallbacks:%u",
+                    hardware->is_async() ? "dma" : "irq",
+                    hardware->get_baudrate(),
+                    (end.isr - begin.isr) / sec,
+                    (end.rx_bytes - begin.rx_bytes) / sec,
+                    (end.tx_bytes - begin.tx_bytes) / sec,
+                    end.rx_errors - begin.rx_errors,
+                    end.tx_errors - begin.tx_errors,
+                    baud.get_fallbacks());
+        for (auto cls : {rosserial_hardware_zephyr::TX_URGENT, rosserial_hardware_zephyr::TX_BULK}) {
+            auto latency{hardware->get_tx_latency(cls)};
+            shell_print(shell,
+                        "%s tx latency frames:%u avg:%uus max:%uus",
+                        cls == rosserial_hardware_zephyr::TX_URGENT ? "urgent" : "bulk",
+                        latency.frames,
+                        latency.frames > 0 ? latency.sum_us / latency.frames : 0,
+                        latency.max_us);
+        }
+    }
+    // The CPU share needs a build with ENABLE_RUNTIME_STATS.
+    void cpu(const shell *shell, uint32_t sec) {
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+        k_thread_runtime_stats_t begin, end;
+        k_thread_runtime_stats_get(get_thread(), &begin);
+#endif  // CONFIG_THREAD_RUNTIME_STATS
+        uint32_t wakeup_begin{get_stats().wakeups};
+        rx_latency_sum_us = rx_latency_max_us = rx_latency_count = 0;
+        k_sleep(K_SECONDS(sec));
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+        k_thread_runtime_stats_get(get_thread(), &end);
+        uint64_t total{static_cast<uint64_t>(sys_clock_hw_cycles_per_sec()) * sec};
+        uint32_t permille{static_cast<uint32_t>((end.execution_cycles - begin.execution_cycles) * 1000 / total)};
+        shell_print(shell, "cpu:%u.%u%%", permille / 10, permille % 10);
+#endif  // CONFIG_THREAD_RUNTIME_STATS
+        shell_print(shell,
+                    "wakeup:%u/s rx latency avg:%uus max:%uus",
+                    (get_stats().wakeups - wakeup_begin) / sec,
+                    rx_latency_count > 0 ? rx_latency_sum_us / rx_latency_count : 0,
+                    rx_latency_max_us);
+    }
+    void stat(const shell *shell) {
+        auto hardware{nh.getHardware()};
+        auto stats{hardware->get_stats()};
+        shell_print(shell,
+                    "rx dropped:%u bytes tx wait:%ums\n"
+                    "high-water rx:%u/%u tx bulk:%u/%u tx urgent:%u/%u",
+                    stats.rx_dropped, stats.tx_wait_us / 1000,
+                    stats.rx_high, hardware->rx_capacity(),
+                    stats.tx_high[rosserial_hardware_zephyr::TX_BULK],
+                    hardware->tx_capacity(rosserial_hardware_zephyr::TX_BULK),
+                    stats.tx_high[rosserial_hardware_zephyr::TX_URGENT],
+                    hardware->tx_capacity(rosserial_hardware_zephyr::TX_URGENT));
+        shell_print(shell,
+                    "imu dropped:%u runaway dropped:%u\n"
+                    "missed actuator:%u bmu:%u board:%u pgv:%u tof:%u uss:%u",
+                    imu_controller::ring.get_dropped(), runaway_detector::ring.get_dropped(),
+                    actuator.get_missed(), bmu.get_missed(), board.get_missed(),
+                    pgv.get_missed(), tof.get_missed(), uss.get_missed());
+        uint32_t begin[32], n{0};
+        ros_publisher::for_each([&](ros_publisher &pub) {
+            if (n < ARRAY_SIZE(begin))
+                begin[n++] = pub.get_bytes();
+        });
+        k_sleep(K_SECONDS(1));
+        n = 0;
+        ros_publisher::for_each([&](ros_publisher &pub) {
+            if (n < ARRAY_SIZE(begin))
+                shell_print(shell, "%s %u bytes/s", pub.topic_, pub.get_bytes() - begin[n++]);
+        });
+    }
+    void cost(const shell *shell) {
+        ros_publisher::for_each([](ros_publisher &pub) {pub.reset_cost();});
+        k_sleep(K_SECONDS(1));
+        shell_print(shell, "templates:%s", ros_template_base::is_enabled() ? "on" : "off");
+        ros_publisher::for_each([&](ros_publisher &pub) {
+            auto cost{pub.get_cost()};
+            if (cost.publishes > 0)
+                shell_print(shell, "%s publishes:%u avg:%u max:%u cycles",
+                            pub.topic_, cost.publishes,
+                            cost.sum_cycles / cost.publishes, cost.max_cycles);
+        });
+    }
+    void latency(const shell *shell) {
+        ros_stamp::for_each([](ros_stamp &stamp) {stamp.reset_latency();});
+        k_sleep(K_SECONDS(1));
+        ros_stamp::for_each([&](ros_stamp &stamp) {
+            auto latency{stamp.get_latency()};
+            shell_print(shell, "%s samples:%u avg:%uus p50:%uus p99:%uus max:%uus",
+                        stamp.get_name(), latency.samples,
+                        latency.samples > 0 ? latency.sum_us / latency.samples : 0,
+                        stamp.percentile_us(50), stamp.percentile_us(99),
+                        latency.max_us);
+        });
+    }
+    void rate(const shell *shell) {
+        struct {
+            uint32_t published, skipped, unchanged;
+        } begin[32];
+        uint32_t n{0};
+        ros_publisher::for_each([&](ros_publisher &pub) {
+            if (n < ARRAY_SIZE(begin))
+                begin[n++] = {pub.get_published(), pub.get_skipped(), pub.get_unchanged()};
+        });
+        k_sleep(K_SECONDS(1));
+        n = 0;
+        ros_publisher::for_each([&](ros_publisher &pub) {
+            if (n < ARRAY_SIZE(begin)) {
+                shell_print(shell, "%s limit:%uHz keepalive:%ums published:%u/s skipped:%u/s unchanged:%u/s",
+                            pub.topic_, pub.get_rate(), pub.get_keepalive(),
+                            pub.get_published() - begin[n].published,
+                            pub.get_skipped() - begin[n].skipped,
+                            pub.get_unchanged() - begin[n].unchanged);
+                ++n;
+            }
+        });
     }
-    void run() {
-        while (true) {
-            nh.spinOnce();
-            actuator.poll();
-            bmu.poll();
-            board.poll(nh);
-            dfu.poll();
-            imu.poll();
-            interlock.poll();
-            led.poll();
-            pgv.poll();
-            tof.poll();
-            uss.poll();
-            towing_unit.poll();
-            k_usleep(1);
+#ifdef ENABLE_ROSSERIAL_BENCH
+    bool bench(const shell *shell, uint32_t hz, uint32_t sec, bool detail) {
+        auto hardware{nh.getHardware()};
+        auto begin{hardware->get_stats()};
+        uint32_t published[32], n{0};
+        ros_publisher::for_each([&](ros_publisher &pub) {
+            if (n < ARRAY_SIZE(published))
+                published[n++] = pub.get_published();
+        });
+        ros_stamp::for_each([](ros_stamp &stamp) {stamp.reset_latency();});
+        uint32_t missed_begin[BENCH_CHANNELS], missed_end[BENCH_CHANNELS];
+        get_bench_missed(missed_begin);
+        auto result{bench_load.run(hz, sec)};
+        // Let the node drain what is still queued.
+        k_msleep(100);
+        auto end{hardware->get_stats()};
+        get_bench_missed(missed_end);
+        // A sample the bridge overwrote before reading it is dropped too.
+        uint32_t missed{0};
+        for (uint32_t i{0}; i < BENCH_CHANNELS; ++i)
+            missed += missed_end[i] - missed_begin[i];
+        shell_print(shell, "%uHz injected:%u dropped:%u tx:%u bytes/s tx wait:%ums rx dropped:%u",
+                    hz, result.injected, result.dropped + missed,
+                    (end.tx_bytes - begin.tx_bytes) / sec,
+                    (end.tx_wait_us - begin.tx_wait_us) / 1000,
+                    end.rx_dropped - begin.rx_dropped);
+        if (detail) {
+            static constexpr const char *name[BENCH_CHANNELS]{"bmu", "board", "pgv", "tof", "uss"};
+            shell_print(shell, "imu dropped:%u", result.dropped);
+            for (uint32_t i{0}; i < BENCH_CHANNELS; ++i)
+                shell_print(shell, "%s dropped:%u", name[i], missed_end[i] - missed_begin[i]);
+            n = 0;
+            ros_publisher::for_each([&](ros_publisher &pub) {
+                if (n < ARRAY_SIZE(published)) {
+                    if (uint32_t count{pub.get_published() - published[n++]}; count > 0)
+                        shell_print(shell, "%s published:%u/s", pub.topic_, count / sec);
+                }
+            });
+            ros_stamp::for_each([&](ros_stamp &stamp) {
+                auto latency{stamp.get_latency()};
+                if (latency.samples > 0)
+                    shell_print(shell, "%s latency p50:%uus p90:%uus p99:%uus max:%uus",
+                                stamp.get_name(), stamp.percentile_us(50), stamp.percentile_us(90),
+                                stamp.percentile_us(99), latency.max_us);
+            });
         }
+        return result.dropped + missed == 0;
+    }
+#endif
+    uint32_t init_events(k_poll_event *events, uint32_t max) override {
+        // The towing unit queue is only initialized on boards with the unit,
+        // it is polled on every wakeup instead.
+        k_poll_signal *signal[]{
+            nh.getHardware()->get_rx_signal(),
+            actuator.get_signal(),
+            bmu.get_signal(),
+            board.get_signal(),
+            pgv.get_signal(),
+            tof.get_signal(),
+            uss.get_signal()
+        };
+        k_msgq *msgq[]{
+            &can_controller::msgq_diagnostics,
+            &firmware_updater::msgq_response,
+            &interlock_controller::msgq_connected_robot_status
+        };
+        uint32_t n{0};
+        for (uint32_t i{0}; i < ARRAY_SIZE(signal) && n < max; ++i)
+            k_poll_event_init(&events[n++], K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, signal[i]);
+        if (n < max)
+            k_poll_event_init(&events[n++], K_POLL_TYPE_SEM_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, imu_controller::ring.get_sem());
+        for (uint32_t i{0}; i < ARRAY_SIZE(msgq) && n < max; ++i)
+            k_poll_event_init(&events[n++], K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, msgq[i]);
+        return n;
     }
 private:
+    static constexpr uint32_t SPIN_PERIOD_MS{10}, DEFAULT_BAUDRATE{921600};
+    // RTS/CTS is requested on every configure, but it only works when the
+    // board routes the pins, which it declares with hw-flow-control.
+    static constexpr bool FLOW_CONTROL{DT_PROP(DT_NODELABEL(usart6), hw_flow_control)};
+    uint32_t rx_latency_sum_us{0}, rx_latency_max_us{0}, rx_latency_count{0};
+    bool prev_connected{false};
     ros::NodeHandle nh;
+#ifdef ENABLE_ROSSERIAL_BENCH
+    // Channels the bench publishes to, in the order of get_bench_missed().
+    static constexpr uint32_t BENCH_CHANNELS{5};
+    void get_bench_missed(uint32_t (&missed)[BENCH_CHANNELS]) const {
+        missed[0] = bmu.get_missed();
+        missed[1] = board.get_missed();
+        missed[2] = pgv.get_missed();
+        missed[3] = tof.get_missed();
+        missed[4] = uss.get_missed();
+    }
+    ros_bench bench_load;
+#endif
     ros_actuator actuator;
+    ros_baud baud;
     ros_bmu bmu;
     ros_board board;
     ros_dfu dfu;
     ros_imu imu;
     ros_interlock interlock;
     ros_led led;
+    ros_link link_diagnostics;
     ros_pgv pgv;
+    ros_robot_state robot_state;
     ros_tof tof;
     ros_uss uss;
     ros_towing_unit towing_unit;
 } impl;
 
-void init()
+int cmd_cpu(const shell *shell, size_t argc, char **argv)
+{
+    int sec{argc > 1 ? atoi(argv[1]) : 1};
+    if (sec <= 0) {
+        shell_error(shell, "Usage: %s %s [seconds]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    impl.cpu(shell, sec);
+    return 0;
+}
+
+int cmd_link(const shell *shell, size_t argc, char **argv)
 {
-    impl.init();
+    int sec{argc > 1 ? atoi(argv[1]) : 1};
+    if (sec <= 0) {
+        shell_error(shell, "Usage: %s %s [seconds]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    impl.link(shell, sec);
+    return 0;
+}
+
+int cmd_keepalive(const shell *shell, size_t argc, char **argv)
+{
+    auto pub{argc == 3 ? ros_publisher::find(argv[1]) : nullptr};
+    if (pub == nullptr || atoi(argv[2]) < 0) {
+        shell_error(shell, "Usage: %s %s <topic> <ms>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    pub->set_keepalive(atoi(argv[2]));
+    return 0;
 }
 
-void run(void *p1, void *p2, void *p3)
+int cmd_stat(const shell *shell, size_t argc, char **argv)
 {
-    impl.run();
+    impl.stat(shell);
+    return 0;
+}
+
+int cmd_cost(const shell *shell, size_t argc, char **argv)
+{
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "on") != 0 && strcmp(argv[1], "off") != 0)) {
+        shell_error(shell, "Usage: %s %s [on|off]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    if (argc == 2)
+        ros_template_base::set_enabled(strcmp(argv[1], "on") == 0);
+    impl.cost(shell);
+    return 0;
+}
+
+int cmd_latency(const shell *shell, size_t argc, char **argv)
+{
+    impl.latency(shell);
+    return 0;
+}
+
+int cmd_nodes(const shell *shell, size_t argc, char **argv)
+{
+    rosserial_node::node::for_each([](rosserial_node::node &n) {n.reset_stats();});
+    k_sleep(K_SECONDS(1));
+    rosserial_node::node::for_each([&](rosserial_node::node &n) {
+        auto stats{n.get_stats()};
+        shell_print(shell, "%s prio:%d idle:%ums wakeup:%u/s spin:%u/s avg:%uus max:%uus",
+                    n.get_name(), n.get_priority(), n.get_idle_ms(),
+                    stats.wakeups, stats.spins,
+                    stats.spins > 0 ? k_cyc_to_us_floor32(stats.sum_cycles / stats.spins) : 0,
+                    k_cyc_to_us_floor32(stats.max_cycles));
+    });
+    return 0;
+}
+
+int cmd_rate(const shell *shell, size_t argc, char **argv)
+{
+    if (argc == 1) {
+        impl.rate(shell);
+        return 0;
+    }
+    auto pub{argc == 3 ? ros_publisher::find(argv[1]) : nullptr};
+    if (pub == nullptr || atoi(argv[2]) < 0) {
+        shell_error(shell, "Usage: %s %s [topic hz]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    if (!pub->set_rate(atoi(argv[2]))) {
+        shell_error(shell, "%s is urgent and not rate limited\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef ENABLE_ROSSERIAL_BENCH
+int cmd_bench(const shell *shell, size_t argc, char **argv)
+{
+    int hz{argc > 1 ? atoi(argv[1]) : 0}, sec{argc > 2 ? atoi(argv[2]) : 1};
+    if (hz < 0 || sec <= 0) {
+        shell_error(shell, "Usage: %s %s [hz (0: sweep)] [seconds]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    if (hz > 0) {
+        impl.bench(shell, hz, sec, true);
+        return 0;
+    }
+    // Doubles the rate until a controller queue overflows or a bridge misses
+    // a sample.
+    uint32_t sustained{0};
+    for (uint32_t i{25}; i <= 3200; i *= 2) {
+        if (!impl.bench(shell, i, sec, false))
+            break;
+        sustained = i;
+    }
+    shell_print(shell, "max sustainable rate:%uHz", sustained);
+    if (sustained > 0)
+        impl.bench(shell, sustained, sec, true);
+    return 0;
 }
+#define SHELL_CMD_BENCH \
+    SHELL_CMD(bench, NULL, "Inject synthetic sensor messages and report rate, drops and latency", cmd_bench),
+#else
+// SHELL_COND_CMD() still names the handler when the option is off.
+#define SHELL_CMD_BENCH
+#endif
 
-k_thread thread;
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD_BENCH
+    SHELL_CMD(cost, NULL, "Publish cost per topic, with message templates on or off", cmd_cost),
+    SHELL_CMD(cpu, NULL, "rosserial thread load and RX wakeup latency", cmd_cpu),
+    SHELL_CMD(keepalive, NULL, "Publish-on-change keepalive per topic (0: publish always)", cmd_keepalive),
+    SHELL_CMD(latency, NULL, "Acquisition to publish latency per sensor", cmd_latency),
+    SHELL_CMD(link, NULL, "UART link rate, ISR rate, throughput, errors and TX latency", cmd_link),
+    SHELL_CMD(nodes, NULL, "Wakeups and spin time per rosserial node", cmd_nodes),
+    SHELL_CMD(rate, NULL, "Publish rate limit per topic (0: unlimited)", cmd_rate),
+    SHELL_CMD(stat, NULL, "Ring high-water marks, drops, missed values and bytes/s per topic", cmd_stat),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(ros, &sub, "rosserial commands", NULL);
 
 }
 
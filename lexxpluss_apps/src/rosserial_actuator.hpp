@@ -26,10 +26,21 @@
 #pragma once
 
 #include <zephyr.h>
+#include <algorithm>
 #include "ros/node_handle.h"
+#if !defined(ENABLE_COMPACT_MSGS)
 #include "std_msgs/Float32MultiArray.h"
+#endif  // ENABLE_COMPACT_MSGS
 #include "std_msgs/Int32MultiArray.h"
+#include "lexxauto_msgs/Float32ArrayStamped.h"
+#if defined(ENABLE_COMPACT_MSGS)
+#include "lexxauto_msgs/LinearActuatorCompact.h"
+#endif  // ENABLE_COMPACT_MSGS
+#include "lexxauto_msgs/Int32ArrayStamped.h"
 #include "lexxauto_msgs/LinearActuatorControlArray.h"
+#include "rosserial_publisher.hpp"
+#include "rosserial_robot_state.hpp"
+#include "rosserial_stamp.hpp"
 #include "actuator_controller.hpp"
 
 namespace lexxhard {
@@ -37,34 +48,96 @@ namespace lexxhard {
 class ros_actuator {
 public:
     void init(ros::NodeHandle &nh) {
+        actuator_controller::chan.subscribe(observer);
         nh.advertise(pub_encoder);
+#if defined(ENABLE_COMPACT_MSGS)
+        nh.advertise(pub_compact);
+#else
         nh.advertise(pub_connection);
         nh.advertise(pub_current);
+#endif  // ENABLE_COMPACT_MSGS
+        nh.advertise(pub_encoder_stamped);
+        nh.advertise(pub_current_stamped);
         nh.subscribe(sub_control);
         msg_encoder.data = msg_encoder_data;
         msg_encoder.data_length = sizeof msg_encoder_data / sizeof msg_encoder_data[0];
+#if !defined(ENABLE_COMPACT_MSGS)
         msg_connection.data = msg_connection_data;
         msg_connection.data_length = sizeof msg_connection_data / sizeof msg_connection_data[0];
         msg_current.data = msg_current_data;
         msg_current.data_length = sizeof msg_current_data / sizeof msg_current_data[0];
+#endif  // ENABLE_COMPACT_MSGS
+        msg_encoder_stamped.data = msg_encoder_data;
+        msg_encoder_stamped.data_length = sizeof msg_encoder_data / sizeof msg_encoder_data[0];
+        msg_current_stamped.data = msg_current_data;
+        msg_current_stamped.data_length = sizeof msg_current_data / sizeof msg_current_data[0];
     }
-    void poll() {
+    void poll(ros::NodeHandle &nh) {
         actuator_controller::msg message;
-        while (k_msgq_get(&actuator_controller::msgq, &message, K_NO_WAIT) == 0) {
+        if (observer.get(message)) {
             // ROS:[center,left,right], ROBOT:[left,center,right]
             msg_encoder.data[0] = message.encoder_count[1];
             msg_encoder.data[1] = message.encoder_count[0];
             msg_encoder.data[2] = message.encoder_count[2];
-            pub_encoder.publish(&msg_encoder);
-            msg_connection.data[0] = message.connect * 1e-3f;
-            pub_connection.publish(&msg_connection);
-            msg_current.data[0] = message.current[1] * 1e-3f;
-            msg_current.data[1] = message.current[0] * 1e-3f;
-            msg_current.data[2] = message.current[2] * 1e-3f;
-            pub_current.publish(&msg_current);
+            msg_connection_data[0] = message.connect * 1e-3f;
+            msg_current_data[0] = message.current[1] * 1e-3f;
+            msg_current_data[1] = message.current[0] * 1e-3f;
+            msg_current_data[2] = message.current[2] * 1e-3f;
+            if (ros_robot_state::is_enabled()) {
+                auto &state{ros_robot_state::get()};
+                for (uint32_t i{0}; i < 3; ++i) {
+                    state.encoder_count[i] = msg_encoder.data[i];
+                    state.linear_actuator_current[i] = msg_current_data[i];
+                }
+                state.shelf_connection = msg_connection_data[0];
+                ros_robot_state::updated(lexxauto_msgs::RobotState::ACTUATOR);
+                stamp.age_us(message.cycle);
+            } else if (ros_stamp::is_enabled()) {
+                // The stamped topics replace encoder_count and
+                // linear_actuator_current. The shelf connection has no
+                // stamped topic, the compact message carries it with the
+                // currents.
+                auto time{stamp.to_ros_time(nh, message.cycle)};
+                msg_encoder_stamped.header.stamp = time;
+                pub_encoder_stamped.publish(&msg_encoder_stamped);
+                msg_current_stamped.header.stamp = time;
+                pub_current_stamped.publish(&msg_current_stamped);
+#if defined(ENABLE_COMPACT_MSGS)
+                publish_compact(message);
+#else
+                pub_connection.publish(&msg_connection);
+#endif  // ENABLE_COMPACT_MSGS
+            } else {
+                pub_encoder.publish(&msg_encoder);
+#if defined(ENABLE_COMPACT_MSGS)
+                publish_compact(message);
+#else
+                pub_connection.publish(&msg_connection);
+                pub_current.publish(&msg_current);
+#endif  // ENABLE_COMPACT_MSGS
+                stamp.age_us(message.cycle);
+            }
         }
     }
+    uint32_t get_missed() const {
+        return observer.get_missed();
+    }
+    k_poll_signal *get_signal() {
+        return observer.get_signal();
+    }
 private:
+#if defined(ENABLE_COMPACT_MSGS)
+    static int16_t clamp_int16(int32_t value) {
+        return std::clamp(value, static_cast<int32_t>(INT16_MIN), static_cast<int32_t>(INT16_MAX));
+    }
+    void publish_compact(const actuator_controller::msg &message) {
+        msg_compact.current_ma[0] = clamp_int16(message.current[1]);
+        msg_compact.current_ma[1] = clamp_int16(message.current[0]);
+        msg_compact.current_ma[2] = clamp_int16(message.current[2]);
+        msg_compact.shelf_connection_mv = std::clamp(message.connect, static_cast<int32_t>(0), static_cast<int32_t>(UINT16_MAX));
+        pub_compact.publish(&msg_compact);
+    }
+#endif  // ENABLE_COMPACT_MSGS
     void callback_control(const lexxauto_msgs::LinearActuatorControlArray &req) {
         actuator_controller::msg_control message;
         // ROS:[center,left,right], ROBOT:[left,center,right]
@@ -78,14 +151,28 @@ private:
             k_msgq_purge(&actuator_controller::msgq_control);
     }
     std_msgs::Int32MultiArray msg_encoder;
+#if defined(ENABLE_COMPACT_MSGS)
+    lexxauto_msgs::LinearActuatorCompact msg_compact;
+#else
     std_msgs::Float32MultiArray msg_connection, msg_current;
+#endif  // ENABLE_COMPACT_MSGS
+    lexxauto_msgs::Int32ArrayStamped msg_encoder_stamped;
+    lexxauto_msgs::Float32ArrayStamped msg_current_stamped;
     int32_t msg_encoder_data[3];
     float msg_connection_data[1], msg_current_data[3];
-    ros::Publisher pub_encoder{"/body_control/encoder_count", &msg_encoder};
-    ros::Publisher pub_connection{"/body_control/shelf_connection", &msg_connection};
-    ros::Publisher pub_current{"/body_control/linear_actuator_current", &msg_current};
+    ros_publisher pub_encoder{"/body_control/encoder_count", &msg_encoder};
+#if defined(ENABLE_COMPACT_MSGS)
+    ros_publisher pub_compact{"/body_control/linear_actuator_compact", &msg_compact};
+#else
+    ros_publisher pub_connection{"/body_control/shelf_connection", &msg_connection};
+    ros_publisher pub_current{"/body_control/linear_actuator_current", &msg_current};
+#endif  // ENABLE_COMPACT_MSGS
+    ros_publisher pub_encoder_stamped{"/body_control/encoder_count_stamped", &msg_encoder_stamped};
+    ros_publisher pub_current_stamped{"/body_control/linear_actuator_current_stamped", &msg_current_stamped};
+    ros_stamp stamp{"actuator"};
     ros::Subscriber<lexxauto_msgs::LinearActuatorControlArray, ros_actuator>
         sub_control{"/body_control/linear_actuator", &ros_actuator::callback_control, this};
+    channel<actuator_controller::msg>::observer observer;
 };
 
 }
@@ -28,6 +28,7 @@
 #include <zephyr.h>
 #include "ros/node_handle.h"
 #include "lexxauto_msgs/InitLinearActuator.h"
+#include "lexxauto_msgs/LinearActuatorJob.h"
 #include "lexxauto_msgs/LinearActuatorLocation.h"
 #include "actuator_controller.hpp"
 
@@ -38,6 +39,26 @@ public:
     void init(ros::NodeHandle &nh) {
         nh.advertiseService(service_location);
         nh.advertiseService(service_init);
+        nh.advertise(pub_job);
+    }
+    void load_params(ros::NodeHandle &nh) {
+        if (int actuator_async; nh.getParam("~actuator_async", &actuator_async, 1, 100))
+            async = actuator_async != 0;
+    }
+    void poll() {
+        actuator_controller::msg_job_status message;
+        while (k_msgq_get(&actuator_controller::msgq_job_status, &message, K_NO_WAIT) == 0) {
+            // ROS:[center,left,right], ROBOT:[left,center,right]
+            msg_job.id = message.id;
+            msg_job.type = message.type;
+            msg_job.state = message.state;
+            msg_job.elapsed_ms = message.elapsed_ms;
+            msg_job.moving = message.moving;
+            msg_job.detail[0] = message.detail[1];
+            msg_job.detail[1] = message.detail[0];
+            msg_job.detail[2] = message.detail[2];
+            pub_job.publish(&msg_job);
+        }
     }
 private:
     void callback_location(const lexxauto_msgs::LinearActuatorLocationRequest &req, lexxauto_msgs::LinearActuatorLocationResponse &res) {
@@ -52,8 +73,11 @@ private:
             req.power.data[0],
             req.power.data[2]
         };
-        uint8_t detail[3];
-        res.success = actuator_controller::to_location(location, power, detail) == 0;
+        uint8_t detail[3]{0, 0, 0};
+        if (async)
+            res.success = actuator_controller::start_to_location(location, power) != 0;
+        else
+            res.success = actuator_controller::to_location(location, power, detail) == 0;
         res.detail.data[0] = detail[1];
         res.detail.data[1] = detail[0];
         res.detail.data[2] = detail[2];
@@ -66,13 +90,18 @@ private:
             req.directions.data[0],
             req.directions.data[2]
         };
-
-        res.success = actuator_controller::init_location(directions) == 0;
+        if (async)
+            res.success = actuator_controller::start_init_location(directions) != 0;
+        else
+            res.success = actuator_controller::init_location(directions) == 0;
     }
     ros::ServiceServer<lexxauto_msgs::LinearActuatorLocationRequest, lexxauto_msgs::LinearActuatorLocationResponse, ros_actuator_service>
         service_location{"/body_control/linear_actuator_location", &ros_actuator_service::callback_location, this};
     ros::ServiceServer<lexxauto_msgs::InitLinearActuatorRequest, lexxauto_msgs::InitLinearActuatorResponse, ros_actuator_service>
         service_init{"/body_control/init_linear_actuator", &ros_actuator_service::callback_init, this};
+    lexxauto_msgs::LinearActuatorJob msg_job;
+    ros::Publisher pub_job{"/body_control/linear_actuator_job", &msg_job};
+    bool async{true};
 };
 
 }
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "ros/node_handle.h"
+#include "std_msgs/UInt32.h"
+#include "rosserial_publisher.hpp"
+
+namespace lexxhard {
+
+// Negotiates the UART rate with the host. The host sends the highest rate it
+// supports on /lexxhard/baud_request, the reply on /lexxhard/baud is the rate
+// both sides will use and this side switches once the reply is out. The host
+// confirms by sending the same request again at the new rate; without it, or
+// on repeated framing errors or a lost connection, the link falls back to the
+// default rate. Without RTS/CTS the UART has no room for a late interrupt or
+// DMA restart above the default rate, so every request is then answered with
+// the default rate.
+class ros_baud {
+public:
+    void init(ros::NodeHandle &nh, uint32_t default_baudrate, bool flow_control) {
+        this->default_baudrate = default_baudrate;
+        this->flow_control = flow_control;
+        nh.subscribe(sub);
+        nh.advertise(pub);
+    }
+    void poll(ros::NodeHandle &nh) {
+        auto hardware{nh.getHardware()};
+        uint32_t rx_errors{hardware->get_stats().rx_errors};
+        int64_t now{k_uptime_get()};
+        if (request_pending) {
+            request_pending = false;
+            uint32_t baudrate{select(requested)};
+            if (baudrate == hardware->get_baudrate()) {
+                if (state_ == state::VERIFYING) {
+                    state_ = state::LOCKED;
+                    since_ms = window_ms = now;
+                    window_errors = rx_errors;
+                }
+            } else {
+                target = baudrate;
+                state_ = state::SWITCHING;
+                since_ms = now;
+            }
+            reply(baudrate);
+        }
+        switch (state_) {
+        case state::SWITCHING:
+            if (hardware->tx_idle() || now - since_ms > SWITCH_TIMEOUT_MS) {
+                hardware->change_baudrate(target);
+                state_ = state::VERIFYING;
+                since_ms = now;
+                window_errors = rx_errors;
+            }
+            break;
+        case state::VERIFYING:
+            if (now - since_ms > VERIFY_TIMEOUT_MS || rx_errors - window_errors > MAX_ERRORS)
+                fallback(nh);
+            break;
+        case state::LOCKED:
+            if (rx_errors - window_errors > MAX_ERRORS) {
+                fallback(nh);
+            } else if (now - window_ms >= ERROR_WINDOW_MS) {
+                window_ms = now;
+                window_errors = rx_errors;
+            }
+            if (nh.connected())
+                since_ms = now;
+            else if (now - since_ms > LOST_TIMEOUT_MS)
+                fallback(nh);
+            break;
+        default:
+            break;
+        }
+    }
+    uint32_t get_fallbacks() const {
+        return fallbacks;
+    }
+private:
+    enum class state {
+        IDLE, SWITCHING, VERIFYING, LOCKED
+    };
+    void callback(const std_msgs::UInt32 &msg) {
+        requested = msg.data;
+        request_pending = true;
+    }
+    uint32_t select(uint32_t requested) const {
+        if (!flow_control)
+            return default_baudrate;
+        for (auto i : BAUDRATES) {
+            if (i <= requested)
+                return i;
+        }
+        return default_baudrate;
+    }
+    void reply(uint32_t baudrate) {
+        msg.data = baudrate;
+        pub.publish(&msg);
+    }
+    void fallback(ros::NodeHandle &nh) {
+        auto hardware{nh.getHardware()};
+        if (hardware->get_baudrate() != default_baudrate) {
+            hardware->change_baudrate(default_baudrate);
+            ++fallbacks;
+        }
+        state_ = state::IDLE;
+    }
+    static constexpr uint32_t BAUDRATES[]{3000000, 2000000, 1500000, 1000000, 921600};
+    static constexpr int64_t SWITCH_TIMEOUT_MS{100}, VERIFY_TIMEOUT_MS{3000};
+    static constexpr int64_t ERROR_WINDOW_MS{1000}, LOST_TIMEOUT_MS{5000};
+    static constexpr uint32_t MAX_ERRORS{10};
+    state state_{state::IDLE};
+    uint32_t default_baudrate{921600}, requested{0}, target{0}, window_errors{0}, fallbacks{0};
+    int64_t since_ms{0}, window_ms{0};
+    bool request_pending{false}, flow_control{false};
+    std_msgs::UInt32 msg;
+    ros_publisher pub{"/lexxhard/baud", &msg, ros_publisher::priority::URGENT};
+    ros::Subscriber<std_msgs::UInt32, ros_baud> sub{"/lexxhard/baud_request", &ros_baud::callback, this};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
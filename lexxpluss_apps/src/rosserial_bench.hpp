@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "can_controller.hpp"
+#include "imu_controller.hpp"
+#include "pgv_controller.hpp"
+#include "tof_controller.hpp"
+#include "uss_controller.hpp"
+
+namespace lexxhard {
+
+// Feeds synthetic controller messages to the rosserial bridges so that the
+// link can be loaded on a bare main board. The host receives the synthetic
+// values on the real topics, so it is only built with ENABLE_ROSSERIAL_BENCH.
+class ros_bench {
+public:
+    struct result {
+        uint32_t injected, dropped;
+    };
+    // Puts one message into each controller queue hz times a second. The
+    // queues are captured for the run, so the controllers' own samples are
+    // discarded meanwhile and every queue keeps a single writer.
+    result run(uint32_t hz, uint32_t sec) {
+        result r{0, 0};
+        capture(true);
+        uint32_t count{hz * sec};
+        int64_t start{k_uptime_ticks()};
+        for (uint32_t i{0}; i < count; ++i) {
+            int64_t due{start + static_cast<int64_t>(k_us_to_ticks_ceil64(static_cast<uint64_t>(i) * 1000000 / hz))};
+            if (int64_t now{k_uptime_ticks()}; now < due)
+                k_sleep(K_TICKS(due - now));
+            inject(r);
+        }
+        capture(false);
+        return r;
+    }
+private:
+    static void capture(bool on) {
+        auto set{[on](auto &queue) {
+            if (on)
+                queue.capture();
+            else
+                queue.release();
+        }};
+        set(imu_controller::ring);
+        set(uss_controller::chan);
+        set(tof_controller::chan);
+        set(pgv_controller::chan);
+        set(can_controller::chan_board);
+        set(can_controller::chan_bmu);
+    }
+    // Values change on every message so that publish-on-change does not
+    // suppress them.
+    void inject(result &r) {
+        ++seq;
+        uint32_t cycle{k_cycle_get_32()};
+        imu_controller::msg imu{};
+        imu.accel[2] = 9.8f + static_cast<float>(seq % 100) * 0.001f;
+        imu.gyro[2] = static_cast<float>(seq % 100) * 0.001f;
+        imu.temp = 30.0f;
+        imu.cycle = cycle;
+        ++r.injected;
+        if (!imu_controller::ring.inject(imu))
+            ++r.dropped;
+        uss_controller::msg uss{};
+        uss.front_left = uss.front_right = uss.left = uss.right = uss.back = 500 + seq % 1000;
+        uss.cycle = cycle;
+        put(uss_controller::chan, uss, r);
+        tof_controller::msg tof{};
+        tof.left = tof.right = 100 + seq % 100;
+        tof.cycle = cycle;
+        put(tof_controller::chan, tof, r);
+        pgv_controller::msg pgv{};
+        pgv.xp = seq;
+        pgv.f.cc2 = true;
+        pgv.cycle = cycle;
+        put(pgv_controller::chan, pgv, r);
+        can_controller::msg_board board{};
+        board.main_board_temp = 30.0f + static_cast<float>(seq % 10) * 0.1f;
+        board.fan_duty = seq % 100;
+        put(can_controller::chan_board, board, r);
+        can_controller::msg_bmu bmu{};
+        bmu.pack_voltage = 48000 + seq % 100;
+        bmu.rsoc = 50;
+        bmu.serial = 1;
+        put(can_controller::chan_bmu, bmu, r);
+    }
+    // The channels keep the latest sample only, what the bridges miss is
+    // counted by their observers.
+    template<typename T>
+    static void put(channel<T> &ch, const T &data, result &r) {
+        ++r.injected;
+        ch.inject(data);
+    }
+    uint32_t seq{0};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -27,8 +27,13 @@
 
 #include <zephyr.h>
 #include <cstdio>
+#include <cstring>
 #include "ros/node_handle.h"
 #include "lexxauto_msgs/Battery.h"
+#include "std_msgs/UInt16MultiArray.h"
+#include "rosserial_publisher.hpp"
+#include "rosserial_robot_state.hpp"
+#include "rosserial_template.hpp"
 #include "can_controller.hpp"
 
 namespace lexxhard {
@@ -36,25 +41,38 @@ namespace lexxhard {
 class ros_bmu {
 public:
     void init(ros::NodeHandle &nh) {
+        can_controller::chan_bmu.subscribe(observer);
         nh.advertise(pub);
+        nh.advertise(pub_freshness);
+        msg_freshness.data = freshness;
+        msg_freshness.data_length = sizeof freshness / sizeof freshness[0];
         msg.temps = temps;
         msg.temps_length = sizeof temps / sizeof temps[0];
+        msg.state.power_supply_technology = sensor_msgs::BatteryState::POWER_SUPPLY_TECHNOLOGY_LION;
+        msg.state.present = true;
+        msg.state.cell_voltage_length = sizeof cell_voltage / sizeof cell_voltage[0];
+        msg.state.cell_voltage = cell_voltage;
+        msg.state.location = "0";
+        msg.state.serial_number = serial;
+        pub.set_keepalive(KEEPALIVE_MS);
     }
     void poll() {
         can_controller::msg_bmu message;
-        while (k_msgq_get(&can_controller::msgq_bmu, &message, K_NO_WAIT) == 0) {
-            float cell_voltage[2];
+        if (observer.get(message)) {
+            publish_freshness(message);
             cell_voltage[0] = message.max_cell_voltage.value;
             cell_voltage[1] = message.min_cell_voltage.value;
-            char serial[8];
-            snprintf(serial, sizeof serial, "%04x", message.serial);
             if (message.mod_status1 & 0b01000000)
                 msg.state.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_FULL;
             else if (message.charging_current > 0)
                 msg.state.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_CHARGING;
             else
                 msg.state.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_DISCHARGING;
-            if (message.mod_status1 & 0b00100000 ||
+            // Values of a stale group are the last ones received, so their
+            // health is unknown until the BMU is heard again.
+            if (message.stale != 0)
+                msg.state.power_supply_health = sensor_msgs::BatteryState::POWER_SUPPLY_HEALTH_UNKNOWN;
+            else if (message.mod_status1 & 0b00100000 ||
                 message.bmu_status == 0x07 ||
                 message.bmu_status == 0x09 ||
                 message.bmu_alarm1 == 0b10000010)
@@ -78,23 +96,96 @@ public:
             msg.state.capacity = message.full_charge_capacity * 1e-2f;
             msg.state.design_capacity = message.design_capacity * 1e-2f;
             msg.state.percentage = message.rsoc * 1e-2f;
-            msg.state.power_supply_technology = sensor_msgs::BatteryState::POWER_SUPPLY_TECHNOLOGY_LION;
-            msg.state.present = true;
-            msg.state.cell_voltage_length = 2;
-            msg.state.cell_voltage = cell_voltage;
-            msg.state.location = "0";
-            msg.state.serial_number = serial;
             msg.temps[0].temperature = message.min_temp.value * 1e-1f;
             msg.temps[1].temperature = message.max_temp.value * 1e-1f;
             msg.temps[2].temperature = message.fet_temp * 1e-1f;
             msg.state_of_health = message.soh;
-            pub.publish(&msg);
+            if (ros_robot_state::is_enabled()) {
+                update_robot_state(message.serial);
+            } else {
+                // The serial number is the only string that changes.
+                if (!tmpl_serial_valid || tmpl_serial != message.serial) {
+                    snprintf(serial, sizeof serial, "%04x", message.serial);
+                    build_template();
+                    tmpl_serial = message.serial;
+                    tmpl_serial_valid = true;
+                }
+                // Receive times change on every frame, values and stale
+                // groups decide.
+                memset(message.received_ms, 0, sizeof message.received_ms);
+                pub.publish_on_change(&tmpl, message);
+            }
         }
     }
+    uint32_t get_missed() const {
+        return observer.get_missed();
+    }
+    k_poll_signal *get_signal() {
+        return observer.get_signal();
+    }
 private:
+    // [stale, received]: the groups not received within the timeout, and
+    // those received since the previous message. Sent when a group goes
+    // stale or comes back, otherwise at most once a second.
+    void publish_freshness(const can_controller::msg_bmu &message) {
+        received |= message.received_since(seen_ms);
+        uint32_t now{k_uptime_get_32()};
+        if (message.stale == freshness[0] && now - freshness_ms < KEEPALIVE_MS)
+            return;
+        freshness[0] = message.stale;
+        freshness[1] = received;
+        pub_freshness.publish(&msg_freshness);
+        received = 0;
+        freshness_ms = now;
+    }
+    void build_template() {
+        tmpl.build(msg.state.voltage,
+                   msg.state.current,
+                   msg.state.charge,
+                   msg.state.capacity,
+                   msg.state.design_capacity,
+                   msg.state.percentage,
+                   msg.state.power_supply_status,
+                   msg.state.power_supply_health,
+                   cell_voltage[0],
+                   cell_voltage[1],
+                   temps[0].temperature,
+                   temps[1].temperature,
+                   temps[2].temperature,
+                   msg.state_of_health);
+    }
+    void update_robot_state(uint16_t serial) {
+        auto &state{ros_robot_state::get()};
+        state.battery_voltage = msg.state.voltage;
+        state.battery_current = msg.state.current;
+        state.battery_charge = msg.state.charge;
+        state.battery_capacity = msg.state.capacity;
+        state.battery_design_capacity = msg.state.design_capacity;
+        state.battery_percentage = msg.state.percentage;
+        state.battery_cell_voltage[0] = msg.state.cell_voltage[0];
+        state.battery_cell_voltage[1] = msg.state.cell_voltage[1];
+        for (uint32_t i{0}; i < 3; ++i)
+            state.battery_temperature[i] = msg.temps[i].temperature;
+        state.battery_status = msg.state.power_supply_status;
+        state.battery_health = msg.state.power_supply_health;
+        state.battery_state_of_health = msg.state_of_health;
+        state.battery_serial = serial;
+        ros_robot_state::updated(lexxauto_msgs::RobotState::BATTERY);
+    }
+    static constexpr uint32_t KEEPALIVE_MS{1000};
     lexxauto_msgs::Battery msg;
     sensor_msgs::Temperature temps[3];
-    ros::Publisher pub{"/sensor_set/battery", &msg};
+    float cell_voltage[2];
+    char serial[8]{""};
+    uint16_t tmpl_serial{0};
+    bool tmpl_serial_valid{false};
+    ros_template<lexxauto_msgs::Battery, 256> tmpl{msg};
+    ros_change_publisher<sizeof (can_controller::msg_bmu)> pub{"/sensor_set/battery", &tmpl};
+    std_msgs::UInt16MultiArray msg_freshness;
+    uint16_t freshness[2]{0, 0}, received{0};
+    uint32_t seen_ms[can_controller::msg_bmu::FRAMES]{}, freshness_ms{0};
+    ros_publisher pub_freshness{"/sensor_set/battery_freshness", &msg_freshness};
+    channel<can_controller::msg_bmu>::observer observer;
 };
 
 }
@@ -27,6 +27,7 @@
 #include <cstdio>
 
 #include <zephyr.h>
+#include <drivers/can.h>
 #include "diagnostic_msgs/DiagnosticArray.h"
 #include "diagnostic_msgs/DiagnosticStatus.h"
 #include "diagnostic_msgs/KeyValue.h"
@@ -40,6 +41,9 @@
 #include "std_msgs/Float32.h"
 #include "lexxauto_msgs/BoardTemperatures.h"
 #include "rosserial_board_store.hpp"
+#include "rosserial_publisher.hpp"
+#include "rosserial_robot_state.hpp"
+#include "rosserial_template.hpp"
 #include "can_controller.hpp"
 
 namespace lexxhard {
@@ -47,6 +51,7 @@ namespace lexxhard {
 class ros_board {
 public:
     void init(ros::NodeHandle &nh) {
+        can_controller::chan_board.subscribe(observer);
         nh.advertise(pub_fan);
         nh.advertise(pub_bumper);
         nh.advertise(pub_emergency);
@@ -56,6 +61,9 @@ public:
         nh.advertise(pub_charge_delay);
         nh.advertise(pub_charge_voltage);
         nh.advertise(pub_diagnostics);
+        for (auto i : {&pub_fan, &pub_bumper, &pub_emergency, &pub_charge, &pub_temperature,
+                       &pub_power, &pub_charge_delay, &pub_charge_voltage})
+            i->set_keepalive(KEEPALIVE_MS);
         nh.subscribe(sub_emergency);
         nh.subscribe(sub_poweroff);
         nh.subscribe(sub_lockdown);
@@ -65,6 +73,13 @@ public:
         msg_fan.data_length = sizeof msg_fan_data / sizeof msg_fan_data[0];
         msg_bumper.data = msg_bumper_data;
         msg_bumper.data_length = sizeof msg_bumper_data / sizeof msg_bumper_data[0];
+        tmpl_temperature.build(msg_temperature.main.temperature,
+                               msg_temperature.power.temperature,
+                               msg_temperature.linear_actuator_center.temperature,
+                               msg_temperature.linear_actuator_left.temperature,
+                               msg_temperature.linear_actuator_right.temperature,
+                               msg_temperature.charge_plus.temperature,
+                               msg_temperature.charge_minus.temperature);
 
         // diagnostics msg keys
         diagnostics_kv[0].key = "error code";
@@ -81,18 +96,39 @@ public:
         poll_board();
         poll_diagnostics(nh);
     }
+    uint32_t get_missed() const {
+        return observer.get_missed();
+    }
+    k_poll_signal *get_signal() {
+        return observer.get_signal();
+    }
 private:
     void poll_board() {
+        // Every queued switch change is published in order, so a press
+        // shorter than a spin still shows up on ROS.
+        can_controller::msg_switch sw;
+        while (k_msgq_get(&can_controller::msgq_switch, &sw, K_NO_WAIT) == 0) {
+            publish_bumper(sw);
+            publish_emergency(sw);
+        }
         can_controller::msg_board message;
-        while (k_msgq_get(&can_controller::msgq_board, &message, K_NO_WAIT) == 0) {
-            publish_fan(message);
-            publish_bumper(message);
-            publish_emergency(message);
-            publish_charge(message);
-            publish_temperature(message);
-            publish_power(message);
-            publish_charge_delay(message);
-            publish_charge_voltage(message);
+        if (observer.get(message)) {
+            can_controller::msg_switch latest{
+                {message.bumper_switch[0], message.bumper_switch[1]},
+                {message.emergency_switch[0], message.emergency_switch[1]}
+            };
+            publish_bumper(latest);
+            publish_emergency(latest);
+            if (ros_robot_state::is_enabled()) {
+                update_robot_state(message);
+            } else {
+                publish_fan(message);
+                publish_charge(message);
+                publish_temperature(message);
+                publish_power(message);
+                publish_charge_delay(message);
+                publish_charge_voltage(message);
+            }
         }
     }
 
@@ -105,26 +141,20 @@ private:
 
     void publish_fan(const can_controller::msg_board &message) {
         msg_fan.data[0] = message.fan_duty;
-        pub_fan.publish(&msg_fan);
+        pub_fan.publish_on_change(&msg_fan, message.fan_duty);
     }
-    void publish_bumper(const can_controller::msg_board &message) {
+    void publish_bumper(const can_controller::msg_switch &message) {
         msg_bumper.data[0] = message.bumper_switch[0];
         msg_bumper.data[1] = message.bumper_switch[1];
-        pub_bumper.publish(&msg_bumper);
+        pub_bumper.publish_on_change(&msg_bumper, message.bumper_switch);
     }
-    void publish_emergency(const can_controller::msg_board &message) {
+    void publish_emergency(const can_controller::msg_switch &message) {
         msg_emergency.data = message.emergency_switch[0] || message.emergency_switch[1];
-        pub_emergency.publish(&msg_emergency);
+        pub_emergency.publish_on_change(&msg_emergency, msg_emergency.data);
     }
     void publish_charge(const can_controller::msg_board &message) {
-        static constexpr uint8_t MANUAL_CHARGE_STATE{6}, AUTO_CHARGE_STATE{5};
-        if (message.state == MANUAL_CHARGE_STATE)
-            msg_charge.data = 2;
-        else if (message.state == AUTO_CHARGE_STATE)
-            msg_charge.data = 1;
-        else
-            msg_charge.data = 0;
-        pub_charge.publish(&msg_charge);
+        msg_charge.data = charge_status(message);
+        pub_charge.publish_on_change(&msg_charge, msg_charge.data);
     }
     void publish_temperature(const can_controller::msg_board &message) {
         msg_temperature.main.temperature = message.main_board_temp;
@@ -135,33 +165,96 @@ private:
         msg_temperature.linear_actuator_right.temperature = message.actuator_board_temp[2];
         msg_temperature.charge_plus.temperature = message.charge_connector_temp[0];
         msg_temperature.charge_minus.temperature = message.charge_connector_temp[1];
-        pub_temperature.publish(&msg_temperature);
+        pub_temperature.publish_on_change(&tmpl_temperature,
+                                          message.main_board_temp,
+                                          message.power_board_temp,
+                                          message.actuator_board_temp,
+                                          message.charge_connector_temp);
     }
     void publish_power(const can_controller::msg_board &message) {
         msg_power.data = message.wait_shutdown ? message.shutdown_reason : 0;
-        pub_power.publish(&msg_power);
+        pub_power.publish_on_change(&msg_power, msg_power.data);
     }
     void publish_charge_delay(const can_controller::msg_board &message) {
         msg_charge_delay.data = message.charge_heartbeat_delay;
-        pub_charge_delay.publish(&msg_charge_delay);
+        pub_charge_delay.publish_on_change(&msg_charge_delay, msg_charge_delay.data);
     }
     void publish_charge_voltage(const can_controller::msg_board &message) {
         msg_charge_voltage.data = message.charge_connector_voltage;
-        pub_charge_voltage.publish(&msg_charge_voltage);
+        pub_charge_voltage.publish_on_change(&msg_charge_voltage, msg_charge_voltage.data);
+    }
+    void update_robot_state(const can_controller::msg_board &message) {
+        auto &state{ros_robot_state::get()};
+        state.fan = message.fan_duty;
+        state.bumper[0] = message.bumper_switch[0];
+        state.bumper[1] = message.bumper_switch[1];
+        state.emergency_switch = message.emergency_switch[0] || message.emergency_switch[1];
+        state.charge_status = charge_status(message);
+        state.power_state = message.wait_shutdown ? message.shutdown_reason : 0;
+        state.charge_heartbeat_delay = message.charge_heartbeat_delay;
+        state.charge_connector_voltage = message.charge_connector_voltage;
+        state.temperature[0] = message.main_board_temp;
+        state.temperature[1] = message.power_board_temp;
+        // ROS:[center,left,right], ROBOT:[left,center,right]
+        state.temperature[2] = message.actuator_board_temp[1];
+        state.temperature[3] = message.actuator_board_temp[0];
+        state.temperature[4] = message.actuator_board_temp[2];
+        state.temperature[5] = message.charge_connector_temp[0];
+        state.temperature[6] = message.charge_connector_temp[1];
+        ros_robot_state::updated(lexxauto_msgs::RobotState::BOARD);
+    }
+    static int8_t charge_status(const can_controller::msg_board &message) {
+        static constexpr uint8_t MANUAL_CHARGE_STATE{6}, AUTO_CHARGE_STATE{5};
+        if (message.state == MANUAL_CHARGE_STATE)
+            return 2;
+        else if (message.state == AUTO_CHARGE_STATE)
+            return 1;
+        else
+            return 0;
     }
     void publish_diagnostics(const can_controller::msg_diagnostics &message, ros::Time stamp) {
         diagnostics_stat.name = "mainboard: can_controller";
         diagnostics_stat.level = diagnostic_msgs::DiagnosticStatus::WARN;
-        diagnostics_stat.message = corrupted_can_msg_msg;
 
-        char cob_id_buf[6];
-        snprintf(cob_id_buf, 6, "%d", message.cob_id);
-        char dlc_buf[2];
-        snprintf(dlc_buf, 2, "%d", message.dlc);
-
-        diagnostics_kv[0].value = corrupted_can_msg_error_code;
-        diagnostics_kv[1].value = cob_id_buf;
-        diagnostics_kv[2].value = dlc_buf;
+        char value_buf[2][12];
+        diagnostics_kv[1].key = "cob-id";
+        diagnostics_kv[2].key = "dlc";
+        snprintf(value_buf[0], sizeof value_buf[0], "%d", message.cob_id);
+        snprintf(value_buf[1], sizeof value_buf[1], "%d", message.dlc);
+        switch (message.error) {
+        case can_controller::msg_diagnostics::STALE:
+            diagnostics_stat.message = stale_can_msg_msg;
+            diagnostics_kv[0].value = stale_can_msg_error_code;
+            break;
+        case can_controller::msg_diagnostics::BUS_STATE:
+            if (message.state == CAN_BUS_OFF) {
+                diagnostics_stat.level = diagnostic_msgs::DiagnosticStatus::ERROR;
+                diagnostics_stat.message = bus_off_can_msg;
+            } else if (message.state == CAN_ERROR_PASSIVE) {
+                diagnostics_stat.message = error_passive_can_msg;
+            } else {
+                diagnostics_stat.level = diagnostic_msgs::DiagnosticStatus::OK;
+                diagnostics_stat.message = error_active_can_msg;
+            }
+            diagnostics_kv[0].value = bus_state_can_error_code;
+            diagnostics_kv[1].key = "tx errors";
+            diagnostics_kv[2].key = "rx errors";
+            snprintf(value_buf[0], sizeof value_buf[0], "%d", message.tx_err_cnt);
+            snprintf(value_buf[1], sizeof value_buf[1], "%d", message.rx_err_cnt);
+            break;
+        case can_controller::msg_diagnostics::OVERFLOW:
+            diagnostics_stat.message = overflow_can_msg;
+            diagnostics_kv[0].value = overflow_can_error_code;
+            diagnostics_kv[2].key = "dropped";
+            snprintf(value_buf[1], sizeof value_buf[1], "%u", message.dropped);
+            break;
+        default:
+            diagnostics_stat.message = corrupted_can_msg_msg;
+            diagnostics_kv[0].value = corrupted_can_msg_error_code;
+            break;
+        }
+        diagnostics_kv[1].value = value_buf[0];
+        diagnostics_kv[2].value = value_buf[1];
 
         static uint32_t seq{0};
         msg_diagnostics.header.seq = seq++;
@@ -208,14 +301,24 @@ private:
         while (k_msgq_put(&can_controller::msgq_control, &ros2board, K_NO_WAIT) != 0)
             k_msgq_purge(&can_controller::msgq_control);
     }
+    static constexpr uint32_t KEEPALIVE_MS{1000}, CHANGE_MAX{24};
     static constexpr const char* corrupted_can_msg_msg = "corrupted can message received";
     static constexpr const char* corrupted_can_msg_error_code = "110";
+    static constexpr const char* stale_can_msg_msg = "can message not received within timeout";
+    static constexpr const char* stale_can_msg_error_code = "111";
+    static constexpr const char* bus_off_can_msg = "can bus off";
+    static constexpr const char* error_passive_can_msg = "can error passive";
+    static constexpr const char* error_active_can_msg = "can error active";
+    static constexpr const char* bus_state_can_error_code = "112";
+    static constexpr const char* overflow_can_msg = "can receive queue overflow";
+    static constexpr const char* overflow_can_error_code = "113";
 
     std_msgs::UInt8MultiArray msg_fan;
     std_msgs::ByteMultiArray msg_bumper;
     std_msgs::Bool msg_emergency;
     std_msgs::Byte msg_charge, msg_power;
     lexxauto_msgs::BoardTemperatures msg_temperature;
+    ros_template<lexxauto_msgs::BoardTemperatures, 256> tmpl_temperature{msg_temperature};
     std_msgs::UInt8 msg_charge_delay;
     std_msgs::Float32 msg_charge_voltage;
     diagnostic_msgs::DiagnosticArray  msg_diagnostics;
@@ -223,15 +326,15 @@ private:
     diagnostic_msgs::KeyValue         diagnostics_kv[3];
     uint8_t msg_fan_data[1];
     int8_t msg_bumper_data[2];
-    ros::Publisher pub_fan{"/sensor_set/fan", &msg_fan};
-    ros::Publisher pub_bumper{"/sensor_set/bumper", &msg_bumper};
-    ros::Publisher pub_emergency{"/sensor_set/emergency_switch", &msg_emergency};
-    ros::Publisher pub_charge{"/body_control/charge_status", &msg_charge};
-    ros::Publisher pub_temperature{"/sensor_set/temperature", &msg_temperature};
-    ros::Publisher pub_power{"/body_control/power_state", &msg_power};
-    ros::Publisher pub_charge_delay{"/body_control/charge_heartbeat_delay", &msg_charge_delay};
-    ros::Publisher pub_charge_voltage{"/body_control/charge_connector_voltage", &msg_charge_voltage};
-    ros::Publisher pub_diagnostics{"/diagnostics", &msg_diagnostics};
+    ros_change_publisher<CHANGE_MAX> pub_fan{"/sensor_set/fan", &msg_fan};
+    ros_change_publisher<CHANGE_MAX> pub_bumper{"/sensor_set/bumper", &msg_bumper, ros_publisher::priority::URGENT};
+    ros_change_publisher<CHANGE_MAX> pub_emergency{"/sensor_set/emergency_switch", &msg_emergency, ros_publisher::priority::URGENT};
+    ros_change_publisher<CHANGE_MAX> pub_charge{"/body_control/charge_status", &msg_charge};
+    ros_change_publisher<CHANGE_MAX> pub_temperature{"/sensor_set/temperature", &tmpl_temperature};
+    ros_change_publisher<CHANGE_MAX> pub_power{"/body_control/power_state", &msg_power};
+    ros_change_publisher<CHANGE_MAX> pub_charge_delay{"/body_control/charge_heartbeat_delay", &msg_charge_delay};
+    ros_change_publisher<CHANGE_MAX> pub_charge_voltage{"/body_control/charge_connector_voltage", &msg_charge_voltage};
+    ros_publisher pub_diagnostics{"/diagnostics", &msg_diagnostics, ros_publisher::priority::URGENT};
     ros::Subscriber<std_msgs::Bool, ros_board> sub_emergency{
         "/control/request_emergency_stop", &ros_board::callback_emergency, this
     };
@@ -248,6 +351,7 @@ private:
         "/lexxhard/mainboard_messenger_heartbeat", &ros_board::callback_messenger, this
     };
     bool prev_emergency_request{false};
+    channel<can_controller::msg_board>::observer observer;
 };
 
 }
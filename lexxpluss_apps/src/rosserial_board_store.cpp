@@ -38,6 +38,7 @@ public:
   }
   lexxhard::can_controller::msg_control get_ros2board() {
     ros2board.auto_charge_request_enable = (atomic_get(&pending_auto_charge) != 0);
+    ros2board.cycle = k_cycle_get_32();
     return ros2board;
   }
 private:
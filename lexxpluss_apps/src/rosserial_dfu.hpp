@@ -42,7 +42,7 @@ public:
         response.data_length = sizeof response_data / sizeof response_data[0];
     }
     void poll() {
-        if (k_msgq_get(&firmware_updater::msgq_response, response.data, K_NO_WAIT) == 0)
+        while (k_msgq_get(&firmware_updater::msgq_response, response.data, K_NO_WAIT) == 0)
             pub.publish(&response);
     }
 private:
@@ -28,6 +28,8 @@
 #include <zephyr.h>
 #include <device.h>
 #include <drivers/uart.h>
+#include <linker/section_tags.h>
+#include <sys/atomic.h>
 #include <sys/ring_buffer.h>
 #include "ros/node_handle.h"
 
@@ -35,19 +37,41 @@ namespace {
 
 class rosserial_hardware_zephyr {
 public:
+    enum tx_class {TX_BULK, TX_URGENT, TX_CLASSES};
+    // Byte counters, bytes lost on a full RX ring, framing, parity and overrun
+    // errors, TX transfers the driver refused, time write() spent waiting for
+    // TX ring space, and ring high-water marks since boot.
+    struct stats {
+        uint32_t isr, rx_bytes, tx_bytes, rx_dropped, rx_errors, tx_errors, tx_wait_us;
+        uint32_t rx_high, tx_high[TX_CLASSES];
+    };
+    struct tx_latency {
+        uint32_t frames, sum_us, max_us;
+    };
     void init(const char *name) {
+        k_poll_signal_init(&rx_signal);
         ring_buf_init(&ringbuf.rx, sizeof ringbuf.rbuf, ringbuf.rbuf);
-        ring_buf_init(&ringbuf.tx, sizeof ringbuf.tbuf, ringbuf.tbuf);
+        ring_buf_init(&tx[TX_BULK].frame, sizeof ringbuf.tframe, ringbuf.tframe);
+        ring_buf_init(&tx[TX_URGENT].frame, sizeof ringbuf.uframe, ringbuf.uframe);
+#ifdef ENABLE_ROSSERIAL_DMA
+        // The TX data rings live in the uncached buffers, also when the link
+        // falls back to interrupts, so a second link in this translation unit
+        // has none and stays down.
+        if (!atomic_cas(&dma_owned, 0, 1))
+            return;
+        ring_buf_init(&tx[TX_BULK].data, sizeof dma.tbuf, dma.tbuf);
+        ring_buf_init(&tx[TX_URGENT].data, sizeof dma.ubuf, dma.ubuf);
+#else
+        ring_buf_init(&tx[TX_BULK].data, sizeof ringbuf.tbuf, ringbuf.tbuf);
+        ring_buf_init(&tx[TX_URGENT].data, sizeof ringbuf.ubuf, ringbuf.ubuf);
+#endif
         uart_dev = device_get_binding(name);
         if (device_is_ready(uart_dev)) {
-            uart_config config{
-                .baudrate{baudrate},
-                .parity{UART_CFG_PARITY_NONE},
-                .stop_bits{UART_CFG_STOP_BITS_1},
-                .data_bits{UART_CFG_DATA_BITS_8},
-                .flow_ctrl{UART_CFG_FLOW_CTRL_RTS_CTS}
-            };
-            uart_configure(uart_dev, &config);
+            configure();
+#ifdef ENABLE_ROSSERIAL_DMA
+            if (init_async())
+                return;
+#endif
             uart_irq_rx_disable(uart_dev);
             uart_irq_tx_disable(uart_dev);
             static const auto uart_isr_trampoline{[](const device* dev, void* user_data){
@@ -61,53 +85,383 @@ public:
     void set_baudrate(uint32_t baudrate) {
         this->baudrate = baudrate;
     }
+    // Switches the rate of a running link, call it once tx_idle() so that no
+    // frame is cut.
+    int change_baudrate(uint32_t baudrate) {
+        if (!device_is_ready(uart_dev))
+            return -1;
+        // The last byte may still be in the shift register.
+        k_msleep(1);
+        this->baudrate = baudrate;
+        return configure();
+    }
+    uint32_t get_baudrate() const {
+        return baudrate;
+    }
+    bool tx_idle() {
+        return tx_remain == 0 &&
+               ring_buf_is_empty(&tx[TX_URGENT].frame) &&
+               ring_buf_is_empty(&tx[TX_BULK].frame);
+    }
+    // The node handle parser pulls one byte at a time, so read() hands out
+    // bytes from a claimed span of the RX ring and releases the whole span
+    // once it is consumed.
     int read() {
-        uint8_t c;
-        uint32_t n{ring_buf_get(&ringbuf.rx, &c, sizeof c)};
-        return n > 0 ? c : -1;
+        if (rx_span.pos == rx_span.len) {
+            read_finish(rx_span.len);
+            rx_span.pos = 0;
+            rx_span.len = read_claim(rx_span.data);
+            if (rx_span.len == 0)
+                return -1;
+        }
+        return rx_span.data[rx_span.pos++];
+    }
+    uint32_t read_claim(uint8_t *&data) {
+        return ring_buf_get_claim(&ringbuf.rx, &data, sizeof ringbuf.rbuf);
+    }
+    void read_finish(uint32_t length) {
+        ring_buf_get_finish(&ringbuf.rx, length);
+    }
+    // Every write is one whole frame. Frames of the urgent class are sent
+    // before any queued bulk frame, but never in the middle of one.
+    void select_tx(tx_class cls) {
+        tx_put = &tx[cls];
     }
     void write(uint8_t* data, int length) {
         if (device_is_ready(uart_dev)) {
+            uint32_t total{static_cast<uint32_t>(length)}, wait_cycle{0};
             while (length > 0) {
-                uint32_t n{ring_buf_put(&ringbuf.tx, data, length)};
-                uart_irq_tx_enable(uart_dev);
+                uint32_t n{ring_buf_put(&tx_put->data, data, length)};
+                kick_tx();
                 data += n;
                 length -= n;
+                if (length > 0 && wait_cycle == 0)
+                    wait_cycle = k_cycle_get_32() | 1;
             }
+            if (wait_cycle != 0)
+                counter.tx_wait_us += k_cyc_to_us_floor32(k_cycle_get_32() - wait_cycle);
+            put_frame(total);
         }
     }
     unsigned long time() {
         return k_uptime_get_32();
     }
+    stats get_stats() const {
+        return counter;
+    }
+    bool is_async() const {
+        return async;
+    }
+    uint32_t rx_capacity() {
+        return ring_buf_capacity_get(&ringbuf.rx);
+    }
+    uint32_t tx_capacity(tx_class cls) {
+        return ring_buf_capacity_get(&tx[cls].data);
+    }
+    // Time from a frame being queued until its last byte is handed to the UART.
+    tx_latency get_tx_latency(tx_class cls) const {
+        return tx[cls].latency;
+    }
+    void reset_tx_latency() {
+        for (auto &i : tx)
+            i.latency = {0, 0, 0};
+    }
+    k_poll_signal *get_rx_signal() {
+        return &rx_signal;
+    }
+    uint32_t take_rx_cycle() {
+        return atomic_set(&rx_cycle, 0);
+    }
 private:
+    struct frame_info {
+        uint16_t length;
+        uint32_t cycle;
+    };
+    struct tx_queue {
+        ring_buf data, frame;
+        tx_latency latency;
+    };
+    int configure() {
+        uart_config config{
+            .baudrate{baudrate},
+            .parity{UART_CFG_PARITY_NONE},
+            .stop_bits{UART_CFG_STOP_BITS_1},
+            .data_bits{UART_CFG_DATA_BITS_8},
+            .flow_ctrl{UART_CFG_FLOW_CTRL_RTS_CTS}
+        };
+        return uart_configure(uart_dev, &config);
+    }
+    void put_rx(const uint8_t *data, uint32_t length) {
+        uint32_t n{ring_buf_put(&ringbuf.rx, data, length)};
+        counter.rx_bytes += length;
+        counter.rx_dropped += length - n;
+        if (uint32_t size{ring_buf_size_get(&ringbuf.rx)}; counter.rx_high < size)
+            counter.rx_high = size;
+    }
+    void notify_rx() {
+        // Stamp of the first byte not yet seen by the spin loop, never zero.
+        atomic_cas(&rx_cycle, 0, k_cycle_get_32() | 1);
+        k_poll_signal_raise(&rx_signal, 0);
+    }
+    void put_frame(uint32_t length) {
+        if (uint32_t size{ring_buf_size_get(&tx_put->data)}; counter.tx_high[tx_put - tx] < size)
+            counter.tx_high[tx_put - tx] = size;
+        frame_info info{static_cast<uint16_t>(length), k_cycle_get_32()};
+        while (ring_buf_put(&tx_put->frame, reinterpret_cast<uint8_t*>(&info), sizeof info) != sizeof info)
+            kick_tx();
+        kick_tx();
+    }
+    // Picks the queue to send from, only between frames. The ISR and the DMA
+    // callback are the only consumers.
+    tx_queue *next_tx() {
+        if (tx_remain == 0) {
+            for (auto i : {&tx[TX_URGENT], &tx[TX_BULK]}) {
+                frame_info info;
+                if (ring_buf_get(&i->frame, reinterpret_cast<uint8_t*>(&info), sizeof info) == sizeof info) {
+                    tx_get = i;
+                    tx_remain = info.length;
+                    tx_cycle = info.cycle;
+                    break;
+                }
+            }
+        }
+        return tx_remain > 0 ? tx_get : nullptr;
+    }
+    void sent_tx(uint32_t length) {
+        counter.tx_bytes += length;
+        tx_remain -= length;
+        if (tx_remain == 0) {
+            auto &l{tx_get->latency};
+            uint32_t us{k_cyc_to_us_floor32(k_cycle_get_32() - tx_cycle)};
+            l.sum_us += us;
+            if (l.max_us < us)
+                l.max_us = us;
+            ++l.frames;
+        }
+    }
+    void kick_tx() {
+#ifdef ENABLE_ROSSERIAL_DMA
+        if (async) {
+            if (atomic_cas(&tx_busy, 0, 1))
+                async_tx_start();
+            return;
+        }
+#endif
+        uart_irq_tx_enable(uart_dev);
+    }
     void uart_isr() {
+        ++counter.isr;
+        if (uart_err_check(uart_dev) != 0)
+            ++counter.rx_errors;
         while (uart_irq_update(uart_dev) && uart_irq_is_pending(uart_dev)) {
             uint8_t buf[64];
             if (uart_irq_rx_ready(uart_dev)) {
-                if (int n{uart_fifo_read(uart_dev, buf, sizeof buf)}; n > 0)
-                    ring_buf_put(&ringbuf.rx, buf, n);
+                if (int n{uart_fifo_read(uart_dev, buf, sizeof buf)}; n > 0) {
+                    put_rx(buf, n);
+                    notify_rx();
+                }
             }
             if (uart_irq_tx_ready(uart_dev)) {
-                if (uint32_t n{ring_buf_get(&ringbuf.tx, buf, 1)}; n > 0)
-                    uart_fifo_fill(uart_dev, buf, n);
+                if (auto queue{next_tx()}; queue != nullptr) {
+                    if (uint32_t n{ring_buf_get(&queue->data, buf, 1)}; n > 0) {
+                        uart_fifo_fill(uart_dev, buf, n);
+                        sent_tx(n);
+                    }
+                }
             }
             if (uart_irq_tx_complete(uart_dev))
                 uart_irq_tx_disable(uart_dev);
         }
     }
+#ifdef ENABLE_ROSSERIAL_DMA
+    // The DMA engine reads the TX rings and writes the RX buffers directly,
+    // so they are kept out of the data cache.
+    bool init_async() {
+        static const auto uart_callback_trampoline{[](const device *dev, uart_event *evt, void *user_data){
+            rosserial_hardware_zephyr *self{static_cast<rosserial_hardware_zephyr*>(user_data)};
+            self->uart_callback(evt);
+        }};
+        k_timer_init(&tx_retry, [](k_timer *timer) {
+            static_cast<rosserial_hardware_zephyr*>(k_timer_user_data_get(timer))->kick_tx();
+        }, nullptr);
+        k_timer_user_data_set(&tx_retry, this);
+        if (uart_callback_set(uart_dev, uart_callback_trampoline, this) == 0 &&
+            uart_rx_enable(uart_dev, dma.rbuf[0], sizeof dma.rbuf[0], RX_TIMEOUT_US) == 0) {
+            rx_next = 1;
+            async = true;
+            return true;
+        }
+        return false;
+    }
+    // One transfer never crosses a frame boundary, so that an urgent frame
+    // waits for at most the bulk frame in flight. A transfer the driver
+    // refuses stays in the ring and is retried from a timer, since the link
+    // may be idle or this may run in the TX done callback.
+    void async_tx_start() {
+        while (true) {
+            if (auto queue{next_tx()}) {
+                uint8_t *data;
+                uint32_t n{ring_buf_get_claim(&queue->data, &data, tx_remain)};
+                if (uart_tx(uart_dev, data, n, TX_TIMEOUT_US) == 0)
+                    return;
+                ring_buf_get_finish(&queue->data, 0);
+                ++counter.tx_errors;
+                atomic_clear(&tx_busy);
+                k_timer_start(&tx_retry, K_MSEC(TX_RETRY_MS), K_NO_WAIT);
+                return;
+            }
+            atomic_clear(&tx_busy);
+            // write() may have queued a frame after next_tx() above came back empty.
+            if ((ring_buf_is_empty(&tx[TX_URGENT].frame) && ring_buf_is_empty(&tx[TX_BULK].frame)) ||
+                !atomic_cas(&tx_busy, 0, 1))
+                return;
+        }
+    }
+    void uart_callback(const uart_event *evt) {
+        ++counter.isr;
+        switch (evt->type) {
+        case UART_TX_DONE:
+        case UART_TX_ABORTED:
+            ring_buf_get_finish(&tx_get->data, evt->data.tx.len);
+            sent_tx(evt->data.tx.len);
+            async_tx_start();
+            break;
+        case UART_RX_RDY:
+            put_rx(evt->data.rx.buf + evt->data.rx.offset, evt->data.rx.len);
+            notify_rx();
+            break;
+        case UART_RX_BUF_REQUEST:
+            uart_rx_buf_rsp(uart_dev, dma.rbuf[rx_next], sizeof dma.rbuf[0]);
+            rx_next ^= 1;
+            break;
+        case UART_RX_STOPPED:
+            ++counter.rx_errors;
+            break;
+        case UART_RX_DISABLED:
+            uart_rx_enable(uart_dev, dma.rbuf[rx_next], sizeof dma.rbuf[0], RX_TIMEOUT_US);
+            rx_next ^= 1;
+            break;
+        default:
+            break;
+        }
+    }
+    struct dma_buffer {
+        uint8_t tbuf[2048], ubuf[1024], rbuf[2][256];
+    };
+    static inline dma_buffer __nocache dma;
+    static inline atomic_t dma_owned{ATOMIC_INIT(0)};
+    static constexpr int32_t RX_TIMEOUT_US{100}, TX_TIMEOUT_US{100000}, TX_RETRY_MS{1};
+    atomic_t tx_busy{ATOMIC_INIT(0)};
+    k_timer tx_retry;
+    uint32_t rx_next{0};
+#endif
+    tx_queue tx[TX_CLASSES];
     struct {
-        ring_buf rx, tx;
-        uint8_t rbuf[1024], tbuf[1024];
+        ring_buf rx;
+        uint8_t rbuf[1024];
+#ifndef ENABLE_ROSSERIAL_DMA
+        uint8_t tbuf[2048], ubuf[1024];
+#endif
+        uint8_t tframe[128 * sizeof (frame_info)], uframe[32 * sizeof (frame_info)];
     } ringbuf;
+    tx_queue *tx_put{&tx[TX_BULK]}, *tx_get{&tx[TX_BULK]};
+    uint32_t tx_remain{0}, tx_cycle{0};
+    struct {
+        uint8_t *data;
+        uint32_t pos, len;
+    } rx_span{nullptr, 0, 0};
+    stats counter{0, 0, 0, 0, 0, 0, 0, 0, {0, 0}};
+    k_poll_signal rx_signal;
+    atomic_t rx_cycle{ATOMIC_INIT(0)};
     uint32_t baudrate{57600};
     const device* uart_dev{nullptr};
+    bool async{false};
 };
 
+// Ids 100..163 fit in the urgent mask, so subscribers and publishers together
+// may not take more than 64 slots.
+static constexpr int ROS_MAX_SUBSCRIBERS{16}, ROS_MAX_PUBLISHERS{40};
+static_assert(100 + ROS_MAX_SUBSCRIBERS + ROS_MAX_PUBLISHERS <= 164);
+
+class rosserial_node_handle : public ros::NodeHandle_<rosserial_hardware_zephyr, ROS_MAX_SUBSCRIBERS, ROS_MAX_PUBLISHERS> {
+public:
+    // A topic without a slot leaves its publisher detached, so every
+    // registration is checked and the topics that did not fit are kept.
+    bool advertise(ros::Publisher &p) {
+        return check(NodeHandle_::advertise(p), p.topic_);
+    }
+    template<typename SubscriberT> bool subscribe(SubscriberT &s) {
+        return check(NodeHandle_::subscribe(s), s.topic_);
+    }
+    template<typename ServiceT> bool advertiseService(ServiceT &srv) {
+        return check(NodeHandle_::advertiseService(srv), srv.topic_);
+    }
+    template<typename F> void for_each_failed(F func) const {
+        for (uint32_t i{0}; i < failed_num && i < FAILED_MAX; ++i)
+            func(failed[i]);
+    }
+    uint32_t get_failed() const {return failed_num;}
+    int publish(int id, const ros::Msg *msg) override {
+        if (id >= 100 && !connected())
+            return 0;
+        auto hardware{getHardware()};
+        hardware->select_tx(is_urgent(id) ? rosserial_hardware_zephyr::TX_URGENT : rosserial_hardware_zephyr::TX_BULK);
+        int result{publish_frame(id, msg)};
+        hardware->select_tx(rosserial_hardware_zephyr::TX_BULK);
+        return result;
+    }
+    // Frames of urgent publishers overtake queued bulk frames on the link.
+    void set_urgent(int id) {
+        if (id >= 100 && id < 164)
+            urgent |= 1ULL << (id - 100);
+    }
+private:
+    bool check(bool result, const char *topic) {
+        if (!result) {
+            if (failed_num < FAILED_MAX)
+                failed[failed_num] = topic;
+            ++failed_num;
+        }
+        return result;
+    }
+    bool is_urgent(int id) const {
+        return id >= 100 && id < 164 && (urgent & 1ULL << (id - 100)) != 0;
+    }
+    // Same framing as NodeHandle_::publish(). rosserial messages cannot tell
+    // their size before serializing, so the frame is built in frame_out and
+    // nothing reaches the TX ring until its length has been checked.
+    int publish_frame(int id, const ros::Msg *msg) {
+        uint8_t *frame{frame_out};
+        int l{msg->serialize(frame + 7)};
+        if (static_cast<uint32_t>(l) + 8 > FRAME_MAX) {
+            logerror("Message from device dropped: message larger than buffer.");
+            return -1;
+        }
+        frame[0] = 0xff;
+        frame[1] = ros::PROTOCOL_VER;
+        frame[2] = static_cast<uint8_t>(static_cast<uint16_t>(l) & 255);
+        frame[3] = static_cast<uint8_t>(static_cast<uint16_t>(l) >> 8);
+        frame[4] = 255 - ((frame[2] + frame[3]) % 256);
+        frame[5] = static_cast<uint8_t>(static_cast<int16_t>(id) & 255);
+        frame[6] = static_cast<uint8_t>(static_cast<int16_t>(id) >> 8);
+        int chk{0};
+        for (int i{5}; i < l + 7; ++i)
+            chk += frame[i];
+        frame[l + 7] = 255 - (chk % 256);
+        getHardware()->write(frame, l + 8);
+        return l + 8;
+    }
+    static constexpr uint32_t FRAME_MAX{512}, FAILED_MAX{8};
+    uint64_t urgent{0};
+    const char *failed[FAILED_MAX];
+    uint32_t failed_num{0};
+    uint8_t frame_out[FRAME_MAX];
+};
 }
 
 namespace ros {
 
-typedef NodeHandle_<rosserial_hardware_zephyr> NodeHandle;
+typedef rosserial_node_handle NodeHandle;
 
 }
 
@@ -28,6 +28,9 @@
 #include <zephyr.h>
 #include "ros/node_handle.h"
 #include "lexxauto_msgs/Imu.h"
+#include "lexxauto_msgs/ImuBatch.h"
+#include "rosserial_publisher.hpp"
+#include "rosserial_stamp.hpp"
 #include "imu_controller.hpp"
 
 namespace lexxhard {
@@ -36,10 +39,32 @@ class ros_imu {
 public:
     void init(ros::NodeHandle &nh) {
         nh.advertise(pub);
+        nh.advertise(pub_batch);
+        nh.advertise(pub_stamped);
+        msg_batch.samples = samples;
     }
-    void poll() {
+    // "~imu_batch" selects the number of samples per /sensor_set/imu_batch
+    // message, 0 or 1 keeps publishing /sensor_set/imu per sample.
+    // "~imu_batch_age_ms" bounds how long the oldest sample of a partial
+    // batch waits, e.g. when the IMU stalls or runs slower than expected.
+    void load_params(ros::NodeHandle &nh) {
+        if (int n; nh.getParam("~imu_batch", &n, 1, 100))
+            batch = n < 0 ? 0 : n > static_cast<int>(MAX_BATCH) ? MAX_BATCH : n;
+        if (int ms; nh.getParam("~imu_batch_age_ms", &ms, 1, 100) && ms > 0)
+            batch_age_ms = ms;
+        msg_batch.samples_length = 0;
+    }
+    void poll(ros::NodeHandle &nh) {
         imu_controller::msg message;
-        while (k_msgq_get(&imu_controller::msgq, &message, K_NO_WAIT) == 0) {
+        while (imu_controller::ring.get(message)) {
+            if (batch > 1) {
+                if (msg_batch.samples_length == 0)
+                    batch_cycle = message.cycle;
+                fill_sample(nh, samples[msg_batch.samples_length++], message);
+                if (msg_batch.samples_length >= batch)
+                    publish_batch();
+                continue;
+            }
             msg.gyro.x = message.gyro[0];
             msg.gyro.y = message.gyro[1];
             msg.gyro.z = message.gyro[2];
@@ -52,14 +77,42 @@ public:
             msg.vel.x = message.delta_vel[0];
             msg.vel.y = message.delta_vel[1];
             msg.vel.z = message.delta_vel[2];
-            pub.publish(&msg);
+            if (ros_stamp::is_enabled()) {
+                fill_sample(nh, msg_stamped, message);
+                pub_stamped.publish(&msg_stamped);
+            } else {
+                pub.publish(&msg);
+                stamp.age_us(message.cycle);
+            }
         }
+        if (msg_batch.samples_length > 0 &&
+            k_cyc_to_ms_floor32(k_cycle_get_32() - batch_cycle) >= batch_age_ms)
+            publish_batch();
     }
 private:
+    void publish_batch() {
+        pub_batch.publish(&msg_batch);
+        msg_batch.samples_length = 0;
+    }
+    void fill_sample(ros::NodeHandle &nh, lexxauto_msgs::ImuSample &sample, const imu_controller::msg &message) {
+        sample.stamp = stamp.to_ros_time(nh, message.cycle);
+        for (int i{0}; i < 3; ++i) {
+            sample.accel[i] = message.accel[i];
+            sample.gyro[i] = message.gyro[i];
+            sample.ang[i] = message.delta_ang[i];
+            sample.vel[i] = message.delta_vel[i];
+        }
+    }
+    static constexpr uint32_t MAX_BATCH{8};
     lexxauto_msgs::Imu msg;
-    ros::Publisher pub{"/sensor_set/imu", &msg};
+    lexxauto_msgs::ImuBatch msg_batch;
+    lexxauto_msgs::ImuSample samples[MAX_BATCH], msg_stamped;
+    uint32_t batch{0}, batch_age_ms{20}, batch_cycle{0};
+    ros_publisher pub{"/sensor_set/imu", &msg};
+    ros_publisher pub_batch{"/sensor_set/imu_batch", &msg_batch};
+    ros_publisher pub_stamped{"/sensor_set/imu_stamped", &msg_stamped};
+    ros_stamp stamp{"imu"};
 };
-
 }
 
 // vim: set expandtab shiftwidth=4:
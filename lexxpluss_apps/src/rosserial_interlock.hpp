@@ -28,6 +28,7 @@
 #include <zephyr.h>
 #include "ros/node_handle.h"
 #include "std_msgs/Bool.h"
+#include "rosserial_publisher.hpp"
 #include "interlock_controller.hpp"
 
 namespace lexxhard {
@@ -53,7 +54,9 @@ private:
             k_msgq_purge(&interlock_controller::msgq_amr_status);
     }
     std_msgs::Bool msg_emergency_stop_at_connected_robot;
-    ros::Publisher pub_emergency_stop_at_connected_robot{"/control/emergency_stop_at_connected_robot", &msg_emergency_stop_at_connected_robot};
+    ros_publisher pub_emergency_stop_at_connected_robot{
+        "/control/emergency_stop_at_connected_robot", &msg_emergency_stop_at_connected_robot, ros_publisher::priority::URGENT
+    };
     ros::Subscriber<std_msgs::Bool, ros_interlock> sub_emergency_stop_at_amr{"/control/emergency_stop_at_amr", &ros_interlock::callback_emergency_stop_at_amr, this};
 };  // class ros_interlock
 
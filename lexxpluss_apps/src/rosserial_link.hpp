@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstdio>
+#include "diagnostic_msgs/DiagnosticArray.h"
+#include "diagnostic_msgs/DiagnosticStatus.h"
+#include "diagnostic_msgs/KeyValue.h"
+#include "ros/node_handle.h"
+#include "rosserial_publisher.hpp"
+
+namespace lexxhard {
+
+// Publishes the rosserial link statistics on /diagnostics.
+class ros_link {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+        msg.status_length = 1;
+        msg.status = &status;
+        status.name = "mainboard: rosserial";
+        status.hardware_id = "mainboard";
+        status.values_length = ARRAY_SIZE(kv);
+        status.values = kv;
+        for (uint32_t i{0}; i < ARRAY_SIZE(kv); ++i) {
+            kv[i].key = KEYS[i];
+            kv[i].value = value[i];
+        }
+    }
+    void record_spin(uint32_t us) {
+        if (spin_max_us < us)
+            spin_max_us = us;
+    }
+    void poll(ros::NodeHandle &nh) {
+        int64_t now{k_uptime_get()};
+        if (now - prev_ms < PERIOD_MS)
+            return;
+        auto hardware{nh.getHardware()};
+        auto stats{hardware->get_stats()};
+        uint32_t ms{static_cast<uint32_t>(now - prev_ms)};
+        snprintf(value[0], sizeof value[0], "%u", (stats.rx_bytes - prev_rx_bytes) * 1000 / ms);
+        snprintf(value[1], sizeof value[1], "%u", (stats.tx_bytes - prev_tx_bytes) * 1000 / ms);
+        snprintf(value[2], sizeof value[2], "%u", stats.rx_dropped);
+        snprintf(value[3], sizeof value[3], "%u/%u", stats.rx_high, hardware->rx_capacity());
+        snprintf(value[4], sizeof value[4], "%u/%u", stats.tx_high[rosserial_hardware_zephyr::TX_BULK],
+                 hardware->tx_capacity(rosserial_hardware_zephyr::TX_BULK));
+        snprintf(value[5], sizeof value[5], "%u/%u", stats.tx_high[rosserial_hardware_zephyr::TX_URGENT],
+                 hardware->tx_capacity(rosserial_hardware_zephyr::TX_URGENT));
+        snprintf(value[6], sizeof value[6], "%u", stats.tx_wait_us / 1000);
+        snprintf(value[7], sizeof value[7], "%u", spin_max_us);
+        snprintf(value[8], sizeof value[8], "%u", hardware->get_baudrate());
+        snprintf(value[9], sizeof value[9], "%u", stats.rx_errors);
+        if (stats.rx_dropped != prev_rx_dropped) {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            status.message = "rx bytes dropped";
+        } else if (stats.rx_errors != prev_rx_errors) {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            status.message = "rx errors";
+        } else {
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.message = "ok";
+        }
+        msg.header.seq = seq++;
+        msg.header.stamp = nh.now();
+        pub.publish(&msg);
+        prev_rx_bytes = stats.rx_bytes;
+        prev_tx_bytes = stats.tx_bytes;
+        prev_rx_dropped = stats.rx_dropped;
+        prev_rx_errors = stats.rx_errors;
+        prev_ms = now;
+        spin_max_us = 0;
+    }
+private:
+    static constexpr int64_t PERIOD_MS{5000};
+    static constexpr const char *KEYS[]{
+        "rx bytes/s", "tx bytes/s", "rx dropped bytes", "rx ring high-water",
+        "tx bulk ring high-water", "tx urgent ring high-water", "tx wait ms", "spin max us",
+        "baudrate", "rx errors"
+    };
+    diagnostic_msgs::DiagnosticArray msg;
+    diagnostic_msgs::DiagnosticStatus status;
+    diagnostic_msgs::KeyValue kv[ARRAY_SIZE(KEYS)];
+    char value[ARRAY_SIZE(KEYS)][16];
+    int64_t prev_ms{0};
+    uint32_t prev_rx_bytes{0}, prev_tx_bytes{0}, prev_rx_dropped{0}, prev_rx_errors{0};
+    uint32_t seq{0}, spin_max_us{0};
+    // Same priority as the board diagnostics on this topic, so that the
+    // host gets its /diagnostics messages in the order they were sent.
+    ros_publisher pub{"/diagnostics", &msg, ros_publisher::priority::URGENT};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
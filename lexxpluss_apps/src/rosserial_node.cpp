@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <algorithm>
+#include "rosserial_node.hpp"
+
+namespace lexxhard::rosserial_node {
+
+LOG_MODULE_REGISTER(rosserial_node);
+
+static constexpr uint32_t MAX_GROUPS{static_cast<uint32_t>(thread_priority::NUM)}, MAX_EVENTS{16};
+K_THREAD_STACK_ARRAY_DEFINE(stacks, MAX_GROUPS, 2048);
+
+class runner {
+public:
+    void init() {
+        node::for_each([&](node &n) {
+            if (n.init() != 0)
+                LOG_ERR("%s init failed.", n.name);
+            group *g{&groups[n.priority]};
+            g->used = true;
+            n.thread = &g->thread;
+            n.events = g->events + g->events_num;
+            n.events_num = n.init_events(n.events, MAX_EVENTS - g->events_num);
+            g->events_num += n.events_num;
+        });
+    }
+    void start() {
+        for (uint32_t i{0}; i < MAX_GROUPS; ++i) {
+            if (groups[i].used)
+                k_thread_create(&groups[i].thread, stacks[i], K_THREAD_STACK_SIZEOF(stacks[i]),
+                                &runner::run, &groups[i], nullptr, nullptr, THREAD_PRIORITY_VALUES[i], K_FP_REGS, K_MSEC(2000));
+        }
+    }
+private:
+    // Nodes of the same priority run on one thread.
+    struct group {
+        k_thread thread;
+        k_poll_event events[MAX_EVENTS];
+        uint32_t events_num{0};
+        bool used{false};
+    };
+    static void run(void *p1, void *p2, void *p3) {
+        auto g{static_cast<group*>(p1)};
+        while (true) {
+            // Sleep until an event fires or the idle period of a node ends.
+            uint32_t now_ms{k_uptime_get_32()};
+            int32_t timeout_ms{INT32_MAX};
+            node::for_each([&](node &n) {
+                if (n.thread == &g->thread)
+                    timeout_ms = std::min(timeout_ms, std::max(static_cast<int32_t>(n.next_ms - now_ms), 0));
+            });
+            if (g->events_num > 0)
+                k_poll(g->events, g->events_num, K_MSEC(timeout_ms));
+            else
+                k_msleep(timeout_ms);
+            now_ms = k_uptime_get_32();
+            node::for_each([&](node &n) {
+                if (n.thread != &g->thread)
+                    return;
+                bool woken{false};
+                for (uint32_t i{0}; i < n.events_num; ++i) {
+                    if (n.events[i].state != K_POLL_STATE_NOT_READY)
+                        woken = true;
+                    n.events[i].state = K_POLL_STATE_NOT_READY;
+                }
+                if (woken)
+                    ++n.counter.wakeups;
+                else if (static_cast<int32_t>(now_ms - n.next_ms) < 0)
+                    return;
+                n.next_ms = now_ms + n.idle_ms;
+                uint32_t cycle{k_cycle_get_32()};
+                n.spin();
+                uint32_t cycles{k_cycle_get_32() - cycle};
+                n.counter.sum_cycles += cycles;
+                if (n.counter.max_cycles < cycles)
+                    n.counter.max_cycles = cycles;
+                ++n.counter.spins;
+            });
+        }
+    }
+    group groups[MAX_GROUPS];
+} impl;
+
+void init()
+{
+    impl.init();
+}
+
+void start()
+{
+    impl.start();
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::rosserial_node {
+
+// Thread priorities of the nodes. Nodes of one priority share a thread, and
+// the runner reserves one stack per entry, so a node added at a listed
+// priority needs no other change.
+enum class thread_priority : uint32_t {LINK, SERVICE, NUM};
+static constexpr int THREAD_PRIORITY_VALUES[]{5, 6};
+static_assert(ARRAY_SIZE(THREAD_PRIORITY_VALUES) == static_cast<uint32_t>(thread_priority::NUM));
+
+// One rosserial link, a node handle over one UART. Every instance is listed
+// and run by this module: nodes of the same priority share one thread, which
+// sleeps until an event of one of its nodes fires or the idle period of a
+// node has passed.
+class node {
+public:
+    struct stats {
+        uint32_t wakeups, spins, sum_cycles, max_cycles;
+    };
+    node(const char *name, thread_priority priority, uint32_t idle_ms) :
+        name{name}, priority{static_cast<uint32_t>(priority)}, idle_ms{idle_ms} {
+        if (tail == nullptr)
+            head = this;
+        else
+            tail->next = this;
+        tail = this;
+    }
+    virtual int init() = 0;
+    // Fills the events that wake the node, returns the number of them. Queue
+    // and semaphore events stay ready while data is left, so spin() takes
+    // everything from the queues it lists here.
+    virtual uint32_t init_events(k_poll_event *events, uint32_t max) = 0;
+    virtual void spin() = 0;
+    const char *get_name() const {return name;}
+    int get_priority() const {return THREAD_PRIORITY_VALUES[priority];}
+    uint32_t get_idle_ms() const {return idle_ms;}
+    stats get_stats() const {return counter;}
+    void reset_stats() {counter = {0, 0, 0, 0};}
+    k_thread *get_thread() const {return thread;}
+    template<typename F>
+    static void for_each(F func) {
+        for (auto i{head}; i != nullptr; i = i->next)
+            func(*i);
+    }
+private:
+    const char *name;
+    const uint32_t priority;
+    const uint32_t idle_ms;
+    node *next{nullptr};
+    k_thread *thread{nullptr};
+    k_poll_event *events{nullptr};
+    uint32_t events_num{0}, next_ms{0};
+    stats counter{0, 0, 0, 0};
+    static inline node *head{nullptr}, *tail{nullptr};
+    friend class runner;
+};
+
+void init();
+void start();
+
+}
+
+// vim: set expandtab shiftwidth=4:
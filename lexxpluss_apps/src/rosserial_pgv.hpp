@@ -30,7 +30,11 @@
 #include "ros/node_handle.h"
 #include "std_msgs/UInt8.h"
 #include "lexxauto_msgs/PositionGuideVision.h"
+#include "lexxauto_msgs/PositionGuideVisionStamped.h"
 #include "common.hpp"
+#include "rosserial_publisher.hpp"
+#include "rosserial_stamp.hpp"
+#include "rosserial_template.hpp"
 #include "pgv_controller.hpp"
 
 namespace lexxhard {
@@ -38,16 +42,32 @@ namespace lexxhard {
 class ros_pgv {
 public:
     void init(ros::NodeHandle &nh) {
+        pgv_controller::chan.subscribe(observer);
         nh.advertise(pub);
+        nh.advertise(pub_stamped);
         nh.subscribe(sub);
+        msg.direction = direction;
     }
-    void poll() {
+    void poll(ros::NodeHandle &nh) {
         pgv_controller::msg message;
-        while (k_msgq_get(&pgv_controller::msgq, &message, K_NO_WAIT) == 0)
-            publish(message);
+        if (observer.get(message)) {
+            fill(message);
+            if (ros_stamp::is_enabled()) {
+                publish_stamped(nh, message);
+            } else {
+                publish();
+                stamp.age_us(message.cycle);
+            }
+        }
+    }
+    uint32_t get_missed() const {
+        return observer.get_missed();
+    }
+    k_poll_signal *get_signal() {
+        return observer.get_signal();
     }
 private:
-    void publish(const pgv_controller::msg &message) {
+    void fill(const pgv_controller::msg &message) {
         float ang{static_cast<float>(message.ang) * 0.1f};
         if (ang < 180.0f)
             ang *= -1.0f;
@@ -60,14 +80,35 @@ private:
         msg.angle = ang * M_PI / 180.0f;
         msg.x_pos = xpos * 1e-4f;
         msg.y_pos = ypos * 1e-4f;
-        msg.direction = direction;
         msg.color_lane_count = message.lane;
         msg.no_color_lane = message.f.nl;
         msg.no_pos = message.f.np;
         msg.tag_detected = message.f.tag;
         msg.control_code1_detected = message.f.cc1;
         msg.control_code2_detected = message.f.cc2;
-        pub.publish(&msg);
+    }
+    void publish() {
+        // The direction is the only string, it changes on /sensor_set/pgv_dir.
+        if (tmpl_outdated) {
+            tmpl.build(msg.angle, msg.x_pos, msg.y_pos, msg.color_lane_count,
+                       msg.no_color_lane, msg.no_pos, msg.tag_detected,
+                       msg.control_code1_detected, msg.control_code2_detected);
+            tmpl_outdated = false;
+        }
+        pub.publish(&tmpl);
+    }
+    void publish_stamped(ros::NodeHandle &nh, const pgv_controller::msg &message) {
+        msg_stamped.header.stamp = stamp.to_ros_time(nh, message.cycle);
+        msg_stamped.angle = msg.angle;
+        msg_stamped.x_pos = msg.x_pos;
+        msg_stamped.y_pos = msg.y_pos;
+        msg_stamped.color_lane_count = msg.color_lane_count;
+        msg_stamped.no_color_lane = msg.no_color_lane;
+        msg_stamped.no_pos = msg.no_pos;
+        msg_stamped.tag_detected = msg.tag_detected;
+        msg_stamped.control_code1_detected = msg.control_code1_detected;
+        msg_stamped.control_code2_detected = msg.control_code2_detected;
+        pub_stamped.publish(&msg_stamped);
     }
     void callback(const std_msgs::UInt8 &req) {
         switch (req.data) {
@@ -84,15 +125,22 @@ private:
             snprintf(direction, sizeof direction, "Straight Ahead");
             break;
         }
+        tmpl_outdated = true;
         pgv_controller::msg_control ros2pgv;
         ros2pgv.dir_command = req.data;
         while (k_msgq_put(&pgv_controller::msgq_control, &ros2pgv, K_NO_WAIT) != 0)
             k_msgq_purge(&pgv_controller::msgq_control);
     }
     lexxauto_msgs::PositionGuideVision msg;
-    ros::Publisher pub{"/sensor_set/pgv", &msg};
+    lexxauto_msgs::PositionGuideVisionStamped msg_stamped;
+    ros_template<lexxauto_msgs::PositionGuideVision, 128> tmpl{msg};
+    ros_publisher pub{"/sensor_set/pgv", &tmpl};
+    ros_publisher pub_stamped{"/sensor_set/pgv_stamped", &msg_stamped};
+    ros_stamp stamp{"pgv"};
     ros::Subscriber<std_msgs::UInt8, ros_pgv> sub{"/sensor_set/pgv_dir", &ros_pgv::callback, this};
     char direction[64]{"Straight Ahead"};
+    bool tmpl_outdated{true};
+    channel<pgv_controller::msg>::observer observer;
 };
 
 }
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstdio>
+#include <cstring>
+#include "ros/node_handle.h"
+
+namespace lexxhard {
+
+// ros::Publisher with a per-topic rate limit, optional publish-on-change and
+// a link priority. Every instance is listed in a table so that the limits can
+// be changed from the shell or ROS parameters. Urgent topics carry safety
+// events and are never rate limited.
+class ros_publisher : public ros::Publisher {
+public:
+    enum class priority {BULK, URGENT};
+    struct cost {
+        uint32_t publishes, sum_cycles, max_cycles;
+    };
+    ros_publisher(const char *topic_name, ros::Msg *msg, priority prio = priority::BULK) :
+        ros::Publisher(topic_name, msg), prio{prio} {
+        if (tail == nullptr)
+            head = this;
+        else
+            tail->next = this;
+        tail = this;
+    }
+    int publish(const ros::Msg *msg) {
+        if (nh_ == nullptr)  // not advertised
+            return -1;
+        uint32_t now_cycle{k_cycle_get_32()};
+        if (period_cycle != 0 && now_cycle - prev_cycle < period_cycle) {
+            ++skipped;
+            return 0;
+        }
+        prev_cycle = now_cycle;
+        ++published;
+        int result{ros::Publisher::publish(msg)};
+        uint32_t cycles{k_cycle_get_32() - now_cycle};
+        stats.sum_cycles += cycles;
+        if (stats.max_cycles < cycles)
+            stats.max_cycles = cycles;
+        ++stats.publishes;
+        if (result > 0)
+            bytes += result;
+        return result;
+    }
+    void set_keepalive(uint32_t keepalive_ms) {
+        this->keepalive_ms = keepalive_ms;
+        keepalive_cycle = static_cast<uint32_t>(static_cast<uint64_t>(sys_clock_hw_cycles_per_sec()) * keepalive_ms / 1000);
+    }
+    bool set_rate(uint32_t rate_hz) {
+        if (prio == priority::URGENT && rate_hz != 0)
+            return false;
+        this->rate_hz = rate_hz;
+        period_cycle = rate_hz > 0 ? sys_clock_hw_cycles_per_sec() / rate_hz : 0;
+        return true;
+    }
+    uint32_t get_rate() const {return rate_hz;}
+    priority get_priority() const {return prio;}
+    uint32_t get_published() const {return published;}
+    uint32_t get_skipped() const {return skipped;}
+    uint32_t get_keepalive() const {return keepalive_ms;}
+    uint32_t get_unchanged() const {return unchanged;}
+    uint32_t get_bytes() const {return bytes;}
+    cost get_cost() const {return stats;}
+    void reset_cost() {stats = {0, 0, 0};}
+    template<typename F>
+    static void for_each(F func) {
+        for (auto i{head}; i != nullptr; i = i->next)
+            func(*i);
+    }
+    static ros_publisher *find(const char *topic_name) {
+        ros_publisher *found{nullptr};
+        for_each([&](ros_publisher &pub) {
+            if (strcmp(pub.topic_, topic_name) == 0)
+                found = &pub;
+        });
+        return found;
+    }
+    // Called after all publishers of nh are advertised.
+    template<typename NodeHandle>
+    static void apply_priority(NodeHandle &nh) {
+        for_each([&](ros_publisher &pub) {
+            if (pub.nh_ == &nh && pub.prio == priority::URGENT)
+                nh.set_urgent(pub.id_);
+        });
+    }
+    // Limits are read from one table, "~publish_limits", with entries of
+    // "<topic> <rate_hz> [<keepalive_ms>]", e.g. "/sensor_set/imu 50". rosserial
+    // needs the length of a list, which "~publish_limits_num" gives, so a
+    // connection costs one parameter request when no limits are set and two
+    // otherwise. Called on every connection, so the new peer's values apply.
+    template<typename NodeHandle>
+    static void load_params(NodeHandle &nh) {
+        for_each([&](ros_publisher &pub) {
+            if (pub.nh_ == &nh)
+                pub.last_valid = false;
+        });
+        int num;
+        if (!nh.getParam("~publish_limits_num", &num, 1, 100) || num <= 0)
+            return;
+        if (num > static_cast<int>(LIMITS_MAX))
+            num = LIMITS_MAX;
+        // Only the spin thread of the node handle reads the table.
+        static char table[LIMITS_MAX][64];
+        static char *entry[LIMITS_MAX];
+        for (uint32_t i{0}; i < LIMITS_MAX; ++i)
+            entry[i] = table[i];
+        if (!nh.getParam("~publish_limits", entry, num, 100))
+            return;
+        for (int i{0}; i < num; ++i) {
+            char topic[48];
+            int rate_hz, keepalive_ms;
+            int n{sscanf(entry[i], "%47s %d %d", topic, &rate_hz, &keepalive_ms)};
+            auto pub{n >= 2 ? find(topic) : nullptr};
+            if (pub == nullptr || pub->nh_ != &nh)
+                continue;
+            if (rate_hz >= 0)
+                pub->set_rate(rate_hz);
+            if (n == 3 && keepalive_ms >= 0)
+                pub->set_keepalive(keepalive_ms);
+        }
+    }
+protected:
+    uint32_t prev_cycle{0}, keepalive_cycle{0};
+    uint32_t published{0}, unchanged{0};
+    bool last_valid{false};
+private:
+    static constexpr uint32_t LIMITS_MAX{16};
+    ros_publisher *next{nullptr};
+    const priority prio;
+    uint32_t rate_hz{0}, period_cycle{0};
+    uint32_t keepalive_ms{0};
+    uint32_t skipped{0}, bytes{0};
+    cost stats{0, 0, 0};
+    static inline ros_publisher *head{nullptr}, *tail{nullptr};
+};
+
+// A publisher that keeps a copy of the last published source values, N bytes
+// at most, to publish only on change.
+template<uint32_t N>
+class ros_change_publisher : public ros_publisher {
+public:
+    using ros_publisher::ros_publisher;
+    // Publishes only when the source values differ from the last published
+    // ones, or the keepalive period has passed. A keepalive of 0 publishes
+    // every time.
+    template<typename... T>
+    int publish_on_change(const ros::Msg *msg, const T&... values) {
+        static_assert((sizeof values + ...) <= N, "values larger than the copy");
+        uint8_t current[N];
+        uint32_t size{0};
+        ((memcpy(current + size, &values, sizeof values), size += sizeof values), ...);
+        if (keepalive_cycle != 0 && last_valid && memcmp(current, last, size) == 0 &&
+            k_cycle_get_32() - prev_cycle < keepalive_cycle) {
+            ++unchanged;
+            return 0;
+        }
+        uint32_t prev_published{published};
+        int result{publish(msg)};
+        if (published != prev_published) {
+            memcpy(last, current, size);
+            last_valid = true;
+        }
+        return result;
+    }
+private:
+    uint8_t last[N];
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
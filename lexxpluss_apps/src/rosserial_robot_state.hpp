@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "ros/node_handle.h"
+#include "lexxauto_msgs/RobotState.h"
+#include "rosserial_publisher.hpp"
+
+namespace lexxhard {
+
+// Bundles the slow changing body state of the board, BMU, ultrasonic, ToF
+// and actuator bridges into one frame. While enabled those bridges fill
+// get() instead of publishing their own topics and this publishes it at
+// "~robot_state_hz".
+class ros_robot_state {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+    }
+    template<typename NodeHandle>
+    void load_params(NodeHandle &nh) {
+        if (int hz; nh.getParam("~robot_state_hz", &hz, 1, 100) && hz >= 0) {
+            period_cycle = hz > 0 ? sys_clock_hw_cycles_per_sec() / hz : 0;
+            msg.updated = 0;
+        }
+    }
+    template<typename NodeHandle>
+    void poll(NodeHandle &nh) {
+        if (period_cycle == 0 || msg.updated == 0)
+            return;
+        uint32_t now_cycle{k_cycle_get_32()};
+        if (now_cycle - prev_cycle < period_cycle)
+            return;
+        prev_cycle = now_cycle;
+        msg.header.stamp = nh.now();
+        ++msg.header.seq;
+        pub.publish(&msg);
+        msg.updated = 0;
+    }
+    static bool is_enabled() {return period_cycle != 0;}
+    static lexxauto_msgs::RobotState &get() {return msg;}
+    static void updated(uint8_t part) {msg.updated |= part;}
+private:
+    uint32_t prev_cycle{0};
+    ros_publisher pub{"/body_control/robot_state", &msg};
+    static inline uint32_t period_cycle{0};
+    static inline lexxauto_msgs::RobotState msg;
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
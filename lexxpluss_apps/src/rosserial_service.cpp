@@ -23,45 +23,55 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <logging/log.h>
 #include "rosserial_hardware_zephyr.hpp"
 #include "rosserial_actuator_service.hpp"
 #include "rosserial_board_service.hpp"
-#include "rosserial_service.hpp"
+#include "rosserial_node.hpp"
 
 namespace lexxhard::rosserial_service {
 
-class {
+LOG_MODULE_REGISTER(rosserial_service);
+
+class rosserial_service_impl : public rosserial_node::node {
 public:
-    int init() {
+    // Requests and actuator job status wake the node, otherwise it only
+    // spins for time sync.
+    rosserial_service_impl() : node{"UART_2", rosserial_node::thread_priority::SERVICE, IDLE_MS} {}
+    int init() override {
         nh.initNode(const_cast<char*>("UART_2"));
         actuator_service.init(nh);
         board_service.init(nh);
-        return 0;
+        nh.for_each_failed([](const char *topic) {
+            LOG_ERR("no slot for %s.", topic);
+        });
+        return nh.get_failed() == 0 ? 0 : -1;
+    }
+    uint32_t init_events(k_poll_event *events, uint32_t max) override {
+        if (max < 2)
+            return 0;
+        k_poll_event_init(&events[0], K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, nh.getHardware()->get_rx_signal());
+        k_poll_event_init(&events[1], K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &actuator_controller::msgq_job_status);
+        return 2;
     }
-    void run() {
-        while (true) {
-            nh.spinOnce();
-            k_usleep(1);
+    void spin() override {
+        k_poll_signal_reset(nh.getHardware()->get_rx_signal());
+        nh.spinOnce();
+        if (bool connected{nh.connected()}; connected != prev_connected) {
+            if (connected)
+                actuator_service.load_params(nh);
+            prev_connected = connected;
         }
+        actuator_service.poll();
     }
 private:
+    static constexpr uint32_t IDLE_MS{100};
+    bool prev_connected{false};
     ros::NodeHandle nh;
     ros_actuator_service actuator_service;
     ros_board_service board_service;
 } impl;
 
-void init()
-{
-    impl.init();
-}
-
-void run(void *p1, void *p2, void *p3)
-{
-    impl.run();
-}
-
-k_thread thread;
-
 }
 
 // vim: set expandtab shiftwidth=4:
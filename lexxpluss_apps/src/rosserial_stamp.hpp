@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "ros/node_handle.h"
+
+namespace lexxhard {
+
+// Maps the acquisition cycle stamp of a controller message to ROS time and
+// keeps the acquisition to publish latency of one sensor, with a log2
+// histogram for percentiles.
+class ros_stamp {
+public:
+    struct latency {
+        uint32_t samples, sum_us, max_us;
+    };
+    explicit ros_stamp(const char *name) : name{name} {
+        if (tail == nullptr)
+            head = this;
+        else
+            tail->next = this;
+        tail = this;
+    }
+    uint32_t age_us(uint32_t cycle) {
+        uint32_t us{k_cyc_to_us_floor32(k_cycle_get_32() - cycle)};
+        stats.sum_us += us;
+        if (stats.max_us < us)
+            stats.max_us = us;
+        ++stats.samples;
+        uint32_t bucket{us == 0 ? 0 : 32 - static_cast<uint32_t>(__builtin_clz(us))};
+        ++histogram[bucket < BUCKETS ? bucket : BUCKETS - 1];
+        return us;
+    }
+    template<typename NodeHandle>
+    ros::Time to_ros_time(NodeHandle &nh, uint32_t cycle) {
+        uint32_t us{age_us(cycle)};
+        ros::Time time{nh.now()};
+        time -= ros::Duration(us / 1000000, us % 1000000 * 1000);
+        return time;
+    }
+    const char *get_name() const {return name;}
+    latency get_latency() const {return stats;}
+    void reset_latency() {
+        stats = {0, 0, 0};
+        for (auto &i : histogram)
+            i = 0;
+    }
+    // Upper bound of the histogram bucket holding the given percentile.
+    uint32_t percentile_us(uint32_t percent) const {
+        uint32_t rank{(stats.samples * percent + 99) / 100}, n{0};
+        for (uint32_t i{0}; i < BUCKETS; ++i) {
+            n += histogram[i];
+            if (n >= rank && n > 0)
+                return i < BUCKETS - 1 ? (1U << i) - 1 : stats.max_us;
+        }
+        return stats.max_us;
+    }
+    // The *_stamped topics are published when "~stamped" is true.
+    static bool is_enabled() {return enabled;}
+    template<typename NodeHandle>
+    static void load_params(NodeHandle &nh) {
+        if (int stamped; nh.getParam("~stamped", &stamped, 1, 100))
+            enabled = stamped != 0;
+    }
+    template<typename F>
+    static void for_each(F func) {
+        for (auto i{head}; i != nullptr; i = i->next)
+            func(*i);
+    }
+private:
+    static constexpr uint32_t BUCKETS{20};
+    const char *name;
+    latency stats{0, 0, 0};
+    uint32_t histogram[BUCKETS]{};
+    ros_stamp *next{nullptr};
+    static inline ros_stamp *head{nullptr}, *tail{nullptr};
+    static inline bool enabled{false};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
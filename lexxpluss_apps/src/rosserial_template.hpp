@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstring>
+#include <type_traits>
+#include "ros/msg.h"
+
+namespace lexxhard {
+
+class ros_template_base {
+public:
+    // Falls back to the full serialize() of every message while disabled, to
+    // compare the publish cost with "ros cost".
+    static bool is_enabled() {return enabled;}
+    static void set_enabled(bool enable) {enabled = enable;}
+protected:
+    // build() serializes into this buffer, sized like a link frame, and checks
+    // the length before anything is copied into a template's own image. It is
+    // shared, so build() is only called from the node thread that publishes.
+    static constexpr uint32_t SCRATCH_SIZE{512};
+    static inline uint8_t scratch[SCRATCH_SIZE];
+private:
+    static inline bool enabled{true};
+};
+
+// Keeps the serialized image of a message whose layout, i.e. string contents
+// and array lengths, does not change between publishes. serialize() copies
+// the image and patches only the numeric fields given to build(), so it is
+// published through the template instead of the message itself.
+template<typename T, uint32_t SIZE, uint32_t FIELDS = 24>
+class ros_template : public ros::Msg, public ros_template_base {
+    static_assert(SIZE <= SCRATCH_SIZE);
+public:
+    explicit ros_template(T &msg) : msg{msg} {}
+    // Serializes msg and locates every field in the image by flipping it and
+    // looking for the changed bytes. Call again after a string or an array
+    // length of msg changed. The template stays disabled if a field is not
+    // found as a raw little endian copy of its value.
+    template<typename... F>
+    bool build(F&... fields) {
+        valid = false;
+        count = 0;
+        length = msg.serialize(scratch);
+        if (length <= 0 || static_cast<uint32_t>(length) > SIZE)
+            return false;
+        memcpy(image, scratch, length);
+        valid = (bind(fields) && ...);
+        return valid;
+    }
+    void invalidate() {valid = false;}
+    int serialize(unsigned char *outbuffer) const override {
+        if (!valid || !is_enabled())
+            return msg.serialize(outbuffer);
+        memcpy(outbuffer, image, length);
+        for (uint32_t i{0}; i < count; ++i)
+            memcpy(outbuffer + fields[i].offset, fields[i].value, fields[i].size);
+        return length;
+    }
+    int deserialize(unsigned char *inbuffer) override {return msg.deserialize(inbuffer);}
+    const char *getType() override {return msg.getType();}
+    const char *getMD5() override {return msg.getMD5();}
+private:
+    template<typename F>
+    bool bind(F &field) {
+        static_assert(std::is_arithmetic_v<F>);
+        if (count >= FIELDS)
+            return false;
+        F saved{field};
+        if constexpr (std::is_same_v<F, bool>) {
+            field = !field;
+        } else {
+            uint8_t bytes[sizeof field];
+            memcpy(bytes, &field, sizeof field);
+            for (auto &i : bytes)
+                i = ~i;
+            memcpy(&field, bytes, sizeof field);
+        }
+        uint8_t *flipped{scratch};
+        int flipped_length{msg.serialize(flipped)};
+        F changed{field};
+        field = saved;
+        if (flipped_length != length)
+            return false;
+        int offset{0};
+        while (offset < length && flipped[offset] == image[offset])
+            ++offset;
+        if (offset + static_cast<int>(sizeof field) > length ||
+            memcmp(flipped + offset, &changed, sizeof field) != 0)
+            return false;
+        fields[count++] = {&field, static_cast<uint16_t>(offset), sizeof field};
+        return true;
+    }
+    struct field_info {
+        const void *value;
+        uint16_t offset;
+        uint16_t size;
+    };
+    T &msg;
+    field_info fields[FIELDS];
+    uint8_t image[SIZE];
+    uint32_t count{0};
+    int length{0};
+    bool valid{false};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
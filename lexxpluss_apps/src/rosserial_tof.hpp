@@ -28,6 +28,10 @@
 #include <zephyr.h>
 #include "ros/node_handle.h"
 #include "std_msgs/Float64MultiArray.h"
+#include "lexxauto_msgs/Float32ArrayStamped.h"
+#include "rosserial_publisher.hpp"
+#include "rosserial_robot_state.hpp"
+#include "rosserial_stamp.hpp"
 #include "tof_controller.hpp"
 
 namespace lexxhard {
@@ -35,23 +39,52 @@ namespace lexxhard {
 class ros_tof {
 public:
     void init(ros::NodeHandle &nh) {
+        tof_controller::chan.subscribe(observer);
         nh.advertise(pub);
+        nh.advertise(pub_stamped);
         msg.data = msg_data;
         msg.data_length = sizeof msg_data / sizeof msg_data[0];
+        msg_stamped.data = msg_stamped_data;
+        msg_stamped.data_length = sizeof msg_stamped_data / sizeof msg_stamped_data[0];
     }
-    void poll() {
+    void poll(ros::NodeHandle &nh) {
         tof_controller::msg message;
-        while (k_msgq_get(&tof_controller::msgq, &message, K_NO_WAIT) == 0) {
+        if (observer.get(message)) {
             static constexpr float meter_per_volt{0.7575f};
             msg.data[0] = message.left * 1e-3f * meter_per_volt;
             msg.data[1] = message.right * 1e-3f * meter_per_volt;
-            pub.publish(&msg);
+            if (ros_robot_state::is_enabled()) {
+                auto &state{ros_robot_state::get()};
+                state.downward[0] = msg.data[0];
+                state.downward[1] = msg.data[1];
+                ros_robot_state::updated(lexxauto_msgs::RobotState::DOWNWARD);
+                stamp.age_us(message.cycle);
+            } else if (ros_stamp::is_enabled()) {
+                msg_stamped.header.stamp = stamp.to_ros_time(nh, message.cycle);
+                msg_stamped.data[0] = msg.data[0];
+                msg_stamped.data[1] = msg.data[1];
+                pub_stamped.publish(&msg_stamped);
+            } else {
+                pub.publish(&msg);
+                stamp.age_us(message.cycle);
+            }
         }
     }
+    uint32_t get_missed() const {
+        return observer.get_missed();
+    }
+    k_poll_signal *get_signal() {
+        return observer.get_signal();
+    }
 private:
     std_msgs::Float64MultiArray msg;
+    lexxauto_msgs::Float32ArrayStamped msg_stamped;
     double msg_data[2];
-    ros::Publisher pub{"/sensor_set/downward", &msg};
+    float msg_stamped_data[2];
+    ros_publisher pub{"/sensor_set/downward", &msg};
+    ros_publisher pub_stamped{"/sensor_set/downward_stamped", &msg_stamped};
+    ros_stamp stamp{"downward"};
+    channel<tof_controller::msg>::observer observer;
 };
 
 }
@@ -29,6 +29,7 @@
 #include "ros/node_handle.h"
 #include "std_msgs/UInt8.h"
 #include "std_msgs/UInt8MultiArray.h"
+#include "rosserial_publisher.hpp"
 #include "towing_unit_controller.hpp"
 
 #define LOADED 1
@@ -77,7 +78,7 @@ private:
     }
     std_msgs::UInt8MultiArray msg_pub;
     u_int8_t msg_data[4];
-    ros::Publisher pub_towing_unit_status{"/sensor_set/towing_unit", &msg_pub};
+    ros_publisher pub_towing_unit_status{"/sensor_set/towing_unit", &msg_pub};
     ros::Subscriber<std_msgs::UInt8, ros_towing_unit> sub_towing_unit_power_on{"/control/towing_unit_power_on", &ros_towing_unit::callback_towing_unit_power_on, this};
 };  // class ros_towing_unit
 
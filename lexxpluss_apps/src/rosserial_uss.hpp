@@ -26,8 +26,17 @@
 #pragma once
 
 #include <zephyr.h>
+#include <algorithm>
 #include "ros/node_handle.h"
+#if defined(ENABLE_COMPACT_MSGS)
+#include "lexxauto_msgs/UltrasonicCompact.h"
+#else
 #include "std_msgs/Float64MultiArray.h"
+#endif  // ENABLE_COMPACT_MSGS
+#include "lexxauto_msgs/Float32ArrayStamped.h"
+#include "rosserial_publisher.hpp"
+#include "rosserial_robot_state.hpp"
+#include "rosserial_stamp.hpp"
 #include "uss_controller.hpp"
 
 namespace lexxhard {
@@ -35,25 +44,74 @@ namespace lexxhard {
 class ros_uss {
 public:
     void init(ros::NodeHandle &nh) {
+        uss_controller::chan.subscribe(observer);
         nh.advertise(pub);
+        nh.advertise(pub_stamped);
+#if !defined(ENABLE_COMPACT_MSGS)
         msg.data = msg_data;
         msg.data_length = sizeof msg_data / sizeof msg_data[0];
+#endif  // ENABLE_COMPACT_MSGS
+        msg_stamped.data = msg_stamped_data;
+        msg_stamped.data_length = sizeof msg_stamped_data / sizeof msg_stamped_data[0];
     }
-    void poll() {
+    void poll(ros::NodeHandle &nh) {
         uss_controller::msg message;
-        while (k_msgq_get(&uss_controller::msgq, &message, K_NO_WAIT) == 0) {
-            msg.data[0] = message.front_left * 1e-3f;
-            msg.data[1] = message.front_right * 1e-3f;
-            msg.data[2] = message.left * 1e-3f;
-            msg.data[3] = message.right * 1e-3f;
-            msg.data[4] = message.back * 1e-3f;
-            pub.publish(&msg);
+        if (observer.get(message)) {
+            const uint32_t range_mm[RANGE_NUM]{
+                message.front_left,
+                message.front_right,
+                message.left,
+                message.right,
+                message.back
+            };
+            if (ros_robot_state::is_enabled()) {
+                auto &state{ros_robot_state::get()};
+                for (uint32_t i{0}; i < RANGE_NUM; ++i)
+                    state.ultrasonic[i] = range_mm[i] * 1e-3f;
+                ros_robot_state::updated(lexxauto_msgs::RobotState::ULTRASONIC);
+                stamp.age_us(message.cycle);
+            } else if (ros_stamp::is_enabled()) {
+                msg_stamped.header.stamp = stamp.to_ros_time(nh, message.cycle);
+                for (uint32_t i{0}; i < RANGE_NUM; ++i)
+                    msg_stamped.data[i] = range_mm[i] * 1e-3f;
+                pub_stamped.publish(&msg_stamped);
+            } else {
+                publish(range_mm);
+                stamp.age_us(message.cycle);
+            }
         }
     }
+    uint32_t get_missed() const {
+        return observer.get_missed();
+    }
+    k_poll_signal *get_signal() {
+        return observer.get_signal();
+    }
 private:
+    static constexpr uint32_t RANGE_NUM{5};
+#if defined(ENABLE_COMPACT_MSGS)
+    void publish(const uint32_t (&range_mm)[RANGE_NUM]) {
+        for (uint32_t i{0}; i < RANGE_NUM; ++i)
+            msg.range_mm[i] = std::min(range_mm[i], static_cast<uint32_t>(UINT16_MAX));
+        pub.publish(&msg);
+    }
+    lexxauto_msgs::UltrasonicCompact msg;
+    ros_publisher pub{"/sensor_set/ultrasonic_compact", &msg};
+#else
+    void publish(const uint32_t (&range_mm)[RANGE_NUM]) {
+        for (uint32_t i{0}; i < RANGE_NUM; ++i)
+            msg.data[i] = range_mm[i] * 1e-3f;
+        pub.publish(&msg);
+    }
     std_msgs::Float64MultiArray msg;
-    double msg_data[5];
-    ros::Publisher pub{"/sensor_set/ultrasonic", &msg};
+    double msg_data[RANGE_NUM];
+    ros_publisher pub{"/sensor_set/ultrasonic", &msg};
+#endif  // ENABLE_COMPACT_MSGS
+    lexxauto_msgs::Float32ArrayStamped msg_stamped;
+    float msg_stamped_data[RANGE_NUM];
+    ros_publisher pub_stamped{"/sensor_set/ultrasonic_stamped", &msg_stamped};
+    ros_stamp stamp{"ultrasonic"};
+    channel<uss_controller::msg>::observer observer;
 };
 
 }
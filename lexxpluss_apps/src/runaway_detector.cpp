@@ -125,12 +125,12 @@ namespace lexxhard::runaway_detector {
 class {
 public:
     int init() {
-        k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
+        ring.init();
         return 0;
     }
     void run() {
         while (true) {
-            if (msg message; k_msgq_get(&msgq, &message, K_MSEC(100)) == 0) {
+            if (msg message; ring.get(message, K_MSEC(100))) {
                 uint32_t current_cycle{k_cycle_get_32()};
                 yaw.new_topic(message.gyro[2], current_cycle);
             }
@@ -138,7 +138,6 @@ public:
     }
 private:
     yaw_checker yaw;
-    char __aligned(4) msgq_buffer[8 * sizeof (msg)]{0};
 } impl;
 
 void init()
@@ -152,7 +151,7 @@ void run(void *p1, void *p2, void *p3)
 }
 
 k_thread thread;
-k_msgq msgq;
+spsc_ring<msg, 8> ring;
 
 }
 
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include "spsc_ring.hpp"
 
 namespace lexxhard::runaway_detector {
 
@@ -37,7 +38,7 @@ struct msg {
 void init();
 void run(void *p1, void *p2, void *p3);
 extern k_thread thread;
-extern k_msgq msgq;
+extern spsc_ring<msg, 8> ring;
 
 }
 
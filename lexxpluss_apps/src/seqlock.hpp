@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <sys/atomic.h>
+
+namespace lexxhard {
+
+// Double buffered sequence lock for one writer. write() fills the buffer
+// that readers are not using and then publishes it, so a reader never waits
+// for a writer it preempted. It only retries when a whole write completes
+// while it copies.
+template<typename T>
+class seqlock {
+public:
+    void write(const T &value) {
+        uint32_t s{get_seq()};
+        buffer[(s + 1) & 1] = value;
+        atomic_set(&seq, s + 1);
+    }
+    // Copies a consistent value and returns its sequence number.
+    uint32_t read(T &value) const {
+        while (true) {
+            uint32_t s{get_seq()};
+            value = buffer[s & 1];
+            compiler_barrier();
+            if (get_seq() == s)
+                return s;
+        }
+    }
+    uint32_t get_seq() const {
+        return static_cast<uint32_t>(atomic_get(&seq));
+    }
+private:
+    T buffer[2]{};
+    atomic_t seq{ATOMIC_INIT(0)};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <sys/atomic.h>
+#include "writer_gate.hpp"
+
+namespace lexxhard {
+
+// Bounded queue from one writer to one reader for streams that must not lose
+// data. When full, put() drops and counts the new value instead of purging
+// the ones still queued. The semaphore counts the queued values.
+template<typename T, uint32_t N>
+class spsc_ring {
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+public:
+    void init() {
+        k_sem_init(&sem, 0, N);
+    }
+    // A value put while a test source holds the ring is discarded.
+    bool put(const T &value) {
+        if (!gate.enter())
+            return true;
+        bool result{inject(value)};
+        gate.leave();
+        return result;
+    }
+    // The test source writes with inject() between capture() and release().
+    bool inject(const T &value) {
+        uint32_t h{static_cast<uint32_t>(atomic_get(&head))};
+        if (h - static_cast<uint32_t>(atomic_get(&tail)) >= N) {
+            ++dropped;
+            return false;
+        }
+        buffer[h % N] = value;
+        atomic_set(&head, h + 1);
+        k_sem_give(&sem);
+        return true;
+    }
+    bool get(T &value, k_timeout_t timeout = K_NO_WAIT) {
+        if (k_sem_take(&sem, timeout) != 0)
+            return false;
+        uint32_t t{static_cast<uint32_t>(atomic_get(&tail))};
+        value = buffer[t % N];
+        atomic_set(&tail, t + 1);
+        return true;
+    }
+    uint32_t get_dropped() const {
+        return dropped;
+    }
+    k_sem *get_sem() {
+        return &sem;
+    }
+    void capture() {gate.capture();}
+    void release() {gate.release();}
+private:
+    T buffer[N];
+    atomic_t head{ATOMIC_INIT(0)}, tail{ATOMIC_INIT(0)};
+    uint32_t dropped{0};
+    k_sem sem;
+    writer_gate gate;
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
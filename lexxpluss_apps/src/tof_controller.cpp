@@ -33,7 +33,6 @@ namespace lexxhard::tof_controller {
 
 LOG_MODULE_REGISTER(tof);
 
-char __aligned(4) msgq_buffer[8 * sizeof (msg)];
 
 int info(const shell *shell, size_t argc, char **argv)
 {
@@ -51,23 +50,22 @@ SHELL_CMD_REGISTER(tof, &sub, "ToF commands", NULL);
 
 void init()
 {
-    k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
 }
 
 void run(void *p1, void *p2, void *p3)
 {
     while (true) {
         msg message;
+        message.cycle = k_cycle_get_32();
         message.left = adc_reader::get(adc_reader::DOWNWARD_L);
         message.right = adc_reader::get(adc_reader::DOWNWARD_R);
-        while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq);
+        chan.publish(message);
         k_msleep(20);
     }
 }
 
 k_thread thread;
-k_msgq msgq;
+channel<msg> chan{"tof"};
 
 }
 
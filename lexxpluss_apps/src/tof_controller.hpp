@@ -26,17 +26,19 @@
 #pragma once
 
 #include <zephyr.h>
+#include "channel.hpp"
 
 namespace lexxhard::tof_controller {
 
 struct msg {
     int32_t left, right;
+    uint32_t cycle;
 } __attribute__((aligned(4)));
 
 void init();
 void run(void *p1, void *p2, void *p3);
 extern k_thread thread;
-extern k_msgq msgq;
+extern channel<msg> chan;
 
 }
 
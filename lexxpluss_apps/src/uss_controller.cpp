@@ -34,7 +34,6 @@ namespace lexxhard::uss_controller {
 
 LOG_MODULE_REGISTER(uss);
 
-char __aligned(4) msgq_buffer[8 * sizeof (msg)];
 
 class uss_fetcher {
 public:
@@ -53,6 +52,14 @@ public:
         distance[0] = this->distance[0];
         distance[1] = this->distance[1];
     }
+    // Also the cycle of the oldest measurement in distance, a missing sensor
+    // does not age the others.
+    void get_distance(uint32_t (&distance)[2], uint32_t &cycle, uint32_t now_cycle) const {
+        get_distance(distance);
+        cycle = device_is_ready(dev[0]) ? this->cycle[0] : now_cycle;
+        if (device_is_ready(dev[1]) && now_cycle - this->cycle[1] > now_cycle - cycle)
+            cycle = this->cycle[1];
+    }
     static void runner(void *p1, void *p2, void *p3) {
         uss_fetcher *self{static_cast<uss_fetcher*>(p1)};
         self->run();
@@ -68,6 +75,7 @@ private:
                 sensor_channel_get(dev[0], SENSOR_CHAN_DISTANCE, &v);
                 int32_t value{v.val1 * 1000 + v.val2 / 1000};
                 distance[0] = distance[0] / 4 + value * 3 / 4;
+                cycle[0] = k_cycle_get_32();
             }
             if (device_is_ready(dev[1])) {
                 if (sensor_sample_fetch_chan(dev[1], SENSOR_CHAN_ALL) == 0) {
@@ -75,13 +83,14 @@ private:
                     sensor_channel_get(dev[1], SENSOR_CHAN_DISTANCE, &v);
                     int32_t value{v.val1 * 1000 + v.val2 / 1000};
                     distance[1] = distance[1] / 4 + value * 3 / 4;
+                    cycle[1] = k_cycle_get_32();
                 }
             }
             k_msleep(1);
         }
     }
     const device *dev[2]{nullptr, nullptr};
-    uint32_t distance[2]{0, 0};
+    uint32_t distance[2]{0, 0}, cycle[2]{0, 0};
 } fetcher[4];
 
 K_THREAD_STACK_DEFINE(fetcher_stack_0, 2048);
@@ -114,7 +123,6 @@ SHELL_CMD_REGISTER(uss, &sub, "USS commands", NULL);
 
 void init()
 {
-    k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
     fetcher[0].init("MB1604_0", "MB1604_1");
     fetcher[1].init("MB1604_2", nullptr);
     fetcher[2].init("MB1604_3", nullptr);
@@ -129,24 +137,29 @@ void run(void *p1, void *p2, void *p3)
     RUN(3);
     while (true) {
         msg message;
-        uint32_t distance[2];
-        fetcher[0].get_distance(distance);
+        uint32_t distance[2], now_cycle{k_cycle_get_32()}, cycle[4];
+        fetcher[0].get_distance(distance, cycle[0], now_cycle);
         message.front_left = distance[0];
         message.front_right = distance[1];
-        fetcher[1].get_distance(distance);
+        fetcher[1].get_distance(distance, cycle[1], now_cycle);
         message.left = distance[0];
-        fetcher[2].get_distance(distance);
+        fetcher[2].get_distance(distance, cycle[2], now_cycle);
         message.right = distance[0];
-        fetcher[3].get_distance(distance);
+        fetcher[3].get_distance(distance, cycle[3], now_cycle);
         message.back = distance[0];
-        while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq);
+        // The message is as old as its oldest range.
+        message.cycle = cycle[0];
+        for (auto i : cycle) {
+            if (now_cycle - i > now_cycle - message.cycle)
+                message.cycle = i;
+        }
+        chan.publish(message);
         k_msleep(100);
     }
 }
 
 k_thread thread;
-k_msgq msgq;
+channel<msg> chan{"uss"};
 
 }
 
@@ -26,18 +26,20 @@
 #pragma once
 
 #include <zephyr.h>
+#include "channel.hpp"
 
 namespace lexxhard::uss_controller {
 
 struct msg {
     uint32_t front_left, front_right;
     uint32_t left, right, back;
+    uint32_t cycle;  // when the oldest range was measured
 } __attribute__((aligned(4)));
 
 void init();
 void run(void *p1, void *p2, void *p3);
 extern k_thread thread;
-extern k_msgq msgq;
+extern channel<msg> chan;
 
 }
 
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <sys/atomic.h>
+
+namespace lexxhard {
+
+// Lets a test source take over a single writer queue or channel. While it is
+// captured the producer's writes are skipped, and capture() returns only once
+// no producer write is in flight, so there is never more than one writer.
+class writer_gate {
+public:
+    bool enter() {
+        atomic_inc(&writing);
+        if (atomic_get(&captured) == 0)
+            return true;
+        atomic_dec(&writing);
+        return false;
+    }
+    void leave() {
+        atomic_dec(&writing);
+    }
+    void capture() {
+        atomic_set(&captured, 1);
+        while (atomic_get(&writing) != 0)
+            k_msleep(1);
+    }
+    void release() {
+        atomic_clear(&captured);
+    }
+private:
+    atomic_t writing{ATOMIC_INIT(0)}, captured{ATOMIC_INIT(0)};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4: